@@ -0,0 +1,130 @@
+#include "pico/stdlib.h"
+#include "host_hal.h"
+#include "chardisp.h"
+#include "keypad_mapped.h"
+#include "events.h"
+#include "ui.h"
+#include "worker.h"
+#include "serialcmd.h"
+#include "outputbuilder.h"
+#include "history.h"
+#include "clockgov.h"
+#include "log.h"
+#include <stdio.h>
+#include <string.h>
+
+// Serial batch protocol check. Sends ":batch hex", a set of lines
+// around the length a job can hold, and ":end" through the stdin
+// stand-in, and compares every reply with what build_truth_table says
+// about the line (or ERR 3 when the line is longer than a job holds).
+// Any difference makes the run fail.
+
+#define SIM_MAX_US 5000000u
+#define SIM_OUT_LEN 4096
+
+static char out[SIM_OUT_LEN];
+static size_t out_len = 0;
+
+static void out_sink(char c) {
+    if (out_len < SIM_OUT_LEN - 1) {
+        out[out_len++] = c;
+    }
+}
+
+static void display_done_cb(void) {
+    ev_post(EV_DISPLAY);
+}
+
+static void serial_chars_cb(void *param) {
+    (void)param;
+    ev_post(EV_SERIAL);
+}
+
+static bool tick_cb(struct repeating_timer *t) {
+    (void)t;
+    ev_post(EV_TICK);
+    return true;
+}
+
+static char lines[8][96];
+static int line_count = 0;
+
+static void add_line(const char *head, char fill, int fills, const char *tail) {
+    char *l = lines[line_count++];
+    strcpy(l, head);
+    memset(l + strlen(l), fill, (size_t)fills);
+    l[strlen(head) + (size_t)fills] = '\0';
+    strcat(l, tail);
+}
+
+// The reply the device owes for one line
+static void expected_reply(const char *line, char *want) {
+    truth_table_t t;
+    int err = strlen(line) > WORKER_EXPR_MAX ? ERR_TOKEN_OVERFLOW : build_truth_table(line, &t);
+    if (err == ERR_OK) {
+        char hex[TT_HEX_LEN + 1];
+        tt_to_hex(t, hex);
+        sprintf(want, "OK %s\n", hex);
+    }
+    else {
+        sprintf(want, "ERR %d\n", err);
+    }
+}
+
+int main(void) {
+    static struct repeating_timer tick_timer;
+
+    stdio_init_all();
+    init_chardisp_pins();
+    cd_init();
+    ui_init();
+    gov_init();
+    q_init();
+    history_init();
+    worker_init();
+    serialcmd_init();
+    add_repeating_timer_ms(10, tick_cb, NULL, &tick_timer);
+    cd_set_done_callback(display_done_cb);
+    stdio_set_chars_available_callback(serial_chars_cb, NULL);
+    host_stdout_set_sink(out_sink);
+
+    add_line("(A|B)&!C", ' ', 0, "");
+    add_line("A", '&', 0, "");
+    add_line("A", ' ', WORKER_EXPR_MAX - 1, "");     // longest a job holds
+    add_line("A", ' ', WORKER_EXPR_MAX - 1, "B");    // one longer: its prefix is valid
+    add_line("A", ' ', WORKER_EXPR_MAX + 1, "|B");
+    add_line("A", ' ', 78, "B");                     // 80, the line buffer's limit
+    add_line("A", ' ', 79, "B");                     // 81, over it
+
+    char want[1024] = "READY\n";
+    host_stdin_push(":batch hex\n", 11);
+    for (int i = 0; i < line_count; i++) {
+        host_stdin_push(lines[i], strlen(lines[i]));
+        host_stdin_push("\n", 1);
+        expected_reply(lines[i], want + strlen(want));
+    }
+    host_stdin_push(":end\n", 5);
+    sprintf(want + strlen(want), "END %d\n", line_count);
+
+    uint64_t t0 = host_now_ns();
+    while (strstr(out, "END ") == NULL && host_now_ns() - t0 < (uint64_t)SIM_MAX_US * 1000u) {
+        ev_dispatch(ui_handlers);
+        log_drain();
+        serialcmd_service();
+    }
+    while (log_free() < LOG_RING_LEN) {
+        log_drain();
+    }
+    host_stdout_set_sink(NULL);
+
+    bool ok = strcmp(out, want) == 0;
+    for (int i = 0; i < line_count; i++) {
+        printf("line %d: %zu chars\n", i, strlen(lines[i]));
+    }
+    printf("replies:\n%s", out);
+    if (!ok) {
+        printf("FAIL: want\n%s", want);
+    }
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
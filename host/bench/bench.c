@@ -0,0 +1,276 @@
+#include "pico/stdlib.h"
+#include "host_hal.h"
+#include "outputbuilder.h"
+#include "keypad_mapped.h"
+#include "chardisp.h"
+#include "gapbuf.h"
+#include "prof.h"
+#include "exprgen.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Microbenchmarks for the portable modules, run under the native
+// environment. Every case runs a fixed workload BENCH_REPEAT times and
+// reports the median, so results compare across changes on the same
+// machine. Usage: bench [name-filter]
+
+#define BENCH_REPEAT 7
+#define BENCH_CHUNK 4 // cd_update calls between drains of the frame queue
+
+typedef struct {
+    const char *name;
+    uint32_t ops;                 // operations per run
+    void (*setup)(void);          // untimed, once per run
+    void (*op)(uint32_t i);       // timed
+    void (*settle)(void);         // untimed, every BENCH_CHUNK ops
+} bench_case_t;
+
+static uint64_t wall_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// ---------------------------------------------------------
+// 1. WORKLOADS
+// ---------------------------------------------------------
+
+// Typical keypad expressions, shortest to deepest nesting
+static const char *const corpus[] = {
+    "A",
+    "!A",
+    "A&B",
+    "A|B&C",
+    "A^B^C",
+    "(A|B)&!C",
+    "!(A&B)|(B^C)",
+    "((A|B)&(B|C))^!(A&C)",
+    "!!!A&!!B|!!!C",
+    "((((A^B)|C)&!A)|(B&!(C^A)))",
+    "(A&B&C)|(!A&!B&!C)|(A^B^C)&!(A|B|C)",
+};
+#define CORPUS_LEN (sizeof(corpus) / sizeof(corpus[0]))
+
+static volatile int sink; // keeps results observable
+
+static void table_op(uint32_t i) {
+    truth_table_t t;
+    sink += build_truth_table(corpus[i % CORPUS_LEN], &t) + t.bits;
+}
+
+// Valid expressions from the fuzzer's generator at its default seed and
+// depth, kept under the token limit: a broad spread of shapes
+#define GEN_CORPUS_LEN 1024
+#define GEN_SEED 1
+static char gen_corpus[GEN_CORPUS_LEN][160];
+
+static void table_gen_setup(void) {
+    exprgen_t g;
+    exprgen_init(&g, GEN_SEED, 6, 63);
+    for (int i = 0; i < GEN_CORPUS_LEN; i++) {
+        exprgen_valid(&g, gen_corpus[i], sizeof(gen_corpus[i]));
+    }
+}
+
+static void table_gen_op(uint32_t i) {
+    truth_table_t t;
+    sink += build_truth_table(gen_corpus[i % GEN_CORPUS_LEN], &t) + t.bits;
+}
+
+// Queries on a packed table: minterm count and a walk over the true rows
+static void tt_query_op(uint32_t i) {
+    truth_table_t t = { (tt_bits_t)(i * 0x9Du) };
+    int acc = tt_count(t);
+    for (int row = tt_first(t); row >= 0; row = tt_next(t, row)) {
+        acc += row;
+    }
+    sink += acc + tt_get(t, i % TT_ROWS);
+}
+
+static void queue_op(uint32_t i) {
+    uint16_t ev;
+    key_push((uint16_t)(KEY_EV_PRESS | (i & 0x7F)));
+    key_pop(&ev);
+    sink += ev;
+}
+
+static void queue_burst_op(uint32_t i) {
+    uint16_t ev;
+    for (int k = 0; k < 16; k++) {
+        key_push((uint16_t)(KEY_EV_PRESS | ((i + (uint32_t)k) & 0x7F)));
+    }
+    while (key_pop(&ev)) {
+        sink += ev;
+    }
+}
+
+static gapbuf_t gb;
+
+static void gb_setup(void) {
+    gb_init(&gb);
+}
+
+// Type a token, move about, back out: the editor's per-key work
+static void gb_op(uint32_t i) {
+    gb_begin_group(&gb);
+    gb_insert(&gb, "AB&|C^"[i % 6]);
+    if (gb_len(&gb) >= GB_CAPACITY - 1) {
+        gb_clear_to_start(&gb);
+    }
+    if (i % 7 == 0) {
+        gb_left(&gb);
+    }
+    if (i % 11 == 0) {
+        gb_undo(&gb);
+    }
+}
+
+// Scrolling an expression through the 16-column window, the case the
+// shadow diff and hardware shift were built for
+static char scroll_text[80];
+
+static void lcd_setup(void) {
+    for (int i = 0; i < (int)sizeof(scroll_text) - 1; i++) {
+        scroll_text[i] = "A&(B|!C)^"[i % 9];
+    }
+    scroll_text[sizeof(scroll_text) - 1] = '\0';
+
+    cd_init();
+    cd_wait_idle();
+}
+
+static void lcd_settle(void) {
+    cd_wait_idle();
+}
+
+static void lcd_scroll_op(uint32_t i) {
+    int start = (int)(i % 48);
+    char l1[17], l2[17];
+    memcpy(l1, scroll_text + start, 16);
+    memcpy(l2, scroll_text + start + 16, 16);
+    l1[16] = l2[16] = '\0';
+    cd_set_view_shift(start % CD_DDRAM_COLS);
+    cd_set_cursor(1, 15, true);
+    sink += cd_update(l1, l2);
+}
+
+// Knob browsing: only the row line changes
+static char row_lines[8][17];
+
+static void lcd_row_setup(void) {
+    for (unsigned r = 0; r < 8; r++) {
+        snprintf(row_lines[r], sizeof(row_lines[r]), "r%u:%u%u%u F=%u      ",
+                 r, (r >> 2) & 1, (r >> 1) & 1, r & 1, (r * 5) & 1);
+    }
+    lcd_setup();
+}
+
+static void lcd_row_op(uint32_t i) {
+    cd_set_view_shift(0);
+    cd_set_cursor(0, 0, false);
+    sink += cd_update("(A|B)&!C        ", row_lines[i & 7]);
+}
+
+// Back buffer + coalescing compositor
+static void lcd_compose_op(uint32_t i) {
+    char *row = cd_back_row(1);
+    row[i % 16] = (char)('A' + (i % 3));
+    cd_invalidate();
+    if (i % 4 == 3) {
+        cd_commit();
+    }
+}
+
+// ---------------------------------------------------------
+// 2. HARNESS
+// ---------------------------------------------------------
+static const bench_case_t cases[] = {
+    { "table",        20000, NULL,      table_op,       NULL },
+    { "table_gen",    20000, table_gen_setup, table_gen_op, NULL },
+    { "tt_query",     200000, NULL,     tt_query_op,    NULL },
+    { "keyq_pushpop", 200000, NULL,     queue_op,       NULL },
+    { "keyq_burst16", 20000, NULL,      queue_burst_op, NULL },
+    { "gapbuf_edit",  200000, gb_setup, gb_op,          NULL },
+    { "lcd_scroll",   20000, lcd_setup, lcd_scroll_op,  lcd_settle },
+    { "lcd_row",      20000, lcd_row_setup, lcd_row_op, lcd_settle },
+    { "lcd_compose",  20000, lcd_setup, lcd_compose_op, lcd_settle },
+};
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void run_case(const bench_case_t *c) {
+    uint64_t ns[BENCH_REPEAT];
+    uint64_t allocs = 0;
+
+    for (int r = 0; r < BENCH_REPEAT; r++) {
+        if (c->setup) {
+            c->setup();
+        }
+        uint64_t a0 = host_alloc_count();
+        uint64_t total = 0;
+        uint32_t i = 0;
+        while (i < c->ops) {
+            uint32_t n = c->settle ? BENCH_CHUNK : c->ops;
+            uint64_t t0 = wall_ns();
+            for (uint32_t k = 0; k < n && i < c->ops; k++, i++) {
+                c->op(i);
+            }
+            total += wall_ns() - t0;
+            if (c->settle) {
+                c->settle();
+            }
+        }
+        allocs += host_alloc_count() - a0;
+        ns[r] = total;
+    }
+
+    qsort(ns, BENCH_REPEAT, sizeof(ns[0]), cmp_u64);
+    printf("%-14s %10.1f ns/op %8.2f allocs/op\n", c->name,
+           (double)ns[BENCH_REPEAT / 2] / c->ops,
+           (double)allocs / ((double)c->ops * BENCH_REPEAT));
+}
+
+// Per-stage split of "table" from the outputbuilder probes
+static void report_stages(void) {
+#if PROF_ENABLE
+    static const struct { prof_id_t id; const char *name; } stages[] = {
+        { PROF_TOKENIZE, "  tokenize" },
+        { PROF_PARSE,    "  parse" },
+        { PROF_EVAL,     "  eval" },
+    };
+    for (size_t s = 0; s < sizeof(stages) / sizeof(stages[0]); s++) {
+        prof_stat_t st;
+        prof_get(stages[s].id, &st);
+        if (st.count) {
+            printf("%-14s %10.1f ns/op (probe, min %lu)\n", stages[s].name,
+                   (double)st.sum / st.count, (unsigned long)st.min);
+        }
+    }
+#endif
+}
+
+int main(int argc, char **argv) {
+    const char *filter = argc > 1 ? argv[1] : NULL;
+
+    stdio_init_all();
+    prof_init();
+    q_init();
+    init_chardisp_pins();
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        if (filter && strstr(cases[i].name, filter) == NULL) {
+            continue;
+        }
+        prof_reset();
+        run_case(&cases[i]);
+        if (strcmp(cases[i].name, "table") == 0) {
+            report_stages();
+        }
+    }
+    return 0;
+}
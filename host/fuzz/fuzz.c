@@ -0,0 +1,304 @@
+#include "outputbuilder.h"
+#include "exprgen.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// Differential fuzzer for the truth table engine. A seeded generator
+// produces grammar-valid and near-valid expressions; each one goes
+// through build_truth_table and through an independent reference
+// (a table-free lexer, an operand/operator state machine, shunting-yard
+// to RPN, and a brute-force evaluation of all eight rows), and the
+// error codes and tables must agree. Fixed boundary cases (token limit,
+// deep nesting, long '!' chains, rejected characters) run first.
+// Reports expressions per second for the engine alone; -w saves the
+// corpus, one per line, for test_tt -f or other tools.
+//
+//   fuzz [-s SEED] [-n COUNT] [-d DEPTH] [-l TOKENS] [-p NEAR_PCT] [-w FILE]
+
+#ifndef MAX_TOKENS
+#define MAX_TOKENS 64 // must match the engine build
+#endif
+#ifndef MAX_NODES
+#define MAX_NODES 64
+#endif
+
+#define FUZZ_EXPR_MAX 192
+#define FUZZ_SHOW_MAX 10 // mismatches printed in full
+
+typedef struct {
+    char text[FUZZ_EXPR_MAX];
+    int err;
+    truth_table_t table;
+} fuzz_case_t;
+
+static uint64_t wall_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// ---------------------------------------------------------
+// 1. REFERENCE EVALUATOR
+// ---------------------------------------------------------
+static int prec(char op) {
+    switch (op) {
+    case '!': return 4;
+    case '&': return 3;
+    case '^': return 2;
+    case '|': return 1;
+    default:  return 0; // '('
+    }
+}
+
+static int ref_eval(const char *expr, truth_table_t *out) {
+    char tok[MAX_TOKENS];
+    int n = 0;
+
+    // Lex: blanks skipped, the END token counts against the limit
+    for (const char *c = expr; *c; c++) {
+        if (*c == ' ' || *c == '\t' || *c == '\n' || *c == '\r') {
+            continue;
+        }
+        if (n >= MAX_TOKENS - 1) {
+            return ERR_TOKEN_OVERFLOW;
+        }
+        char u = *c >= 'a' && *c <= 'z' ? (char)(*c - 'a' + 'A') : *c;
+        if (!strchr("ABC!&|^()", u)) {
+            return ERR_UNKNOWN_CHAR;
+        }
+        tok[n++] = u;
+    }
+
+    // Shape: operands and binary operators alternate, parens balance
+    bool want_operand = true;
+    int depth = 0, nodes = 0;
+    bool ok = true;
+    for (int i = 0; i < n; i++) {
+        char t = tok[i];
+        nodes += t != '(' && t != ')';
+        if (want_operand) {
+            if (t >= 'A' && t <= 'C') {
+                want_operand = false;
+            }
+            else if (t == '(') {
+                depth++;
+            }
+            else if (t != '!') {
+                ok = false;
+            }
+        }
+        else if (t == ')' && depth > 0) {
+            depth--;
+        }
+        else if (t == '&' || t == '|' || t == '^') {
+            want_operand = true;
+        }
+        else {
+            ok = false;
+        }
+    }
+    ok = ok && !want_operand && depth == 0;
+    if (!ok) {
+        // The engine allocates as it parses, so an invalid expression
+        // long enough may run out of nodes before the error is seen
+        return nodes > MAX_NODES ? -1 : ERR_SYNTAX;
+    }
+    if (nodes > MAX_NODES) {
+        return ERR_NODE_POOL;
+    }
+
+    // Shunting-yard to RPN; '!' is prefix so it is never popped by another '!'
+    char rpn[MAX_TOKENS], ops[MAX_TOKENS];
+    int nr = 0, no = 0;
+    for (int i = 0; i < n; i++) {
+        char t = tok[i];
+        if (t >= 'A' && t <= 'C') {
+            rpn[nr++] = t;
+        }
+        else if (t == '!' || t == '(') {
+            ops[no++] = t;
+        }
+        else if (t == ')') {
+            while (ops[no - 1] != '(') {
+                rpn[nr++] = ops[--no];
+            }
+            no--;
+        }
+        else {
+            while (no > 0 && prec(ops[no - 1]) >= prec(t)) {
+                rpn[nr++] = ops[--no];
+            }
+            ops[no++] = t;
+        }
+    }
+    while (no > 0) {
+        rpn[nr++] = ops[--no];
+    }
+
+    // Every row, one at a time
+    truth_table_t t = { 0 };
+    for (unsigned row = 0; row < TT_ROWS; row++) {
+        bool st[MAX_TOKENS];
+        int sp = 0;
+        for (int i = 0; i < nr; i++) {
+            switch (rpn[i]) {
+            case 'A': st[sp++] = (row >> 2) & 1; break;
+            case 'B': st[sp++] = (row >> 1) & 1; break;
+            case 'C': st[sp++] = row & 1; break;
+            case '!': st[sp - 1] = !st[sp - 1]; break;
+            case '&': sp--; st[sp - 1] = st[sp - 1] && st[sp]; break;
+            case '|': sp--; st[sp - 1] = st[sp - 1] || st[sp]; break;
+            case '^': sp--; st[sp - 1] = st[sp - 1] != st[sp]; break;
+            }
+        }
+        tt_set(&t, row, st[0]);
+    }
+    *out = t;
+    return ERR_OK;
+}
+
+// ---------------------------------------------------------
+// 2. CORPUS
+// ---------------------------------------------------------
+static void fill_repeat(char *out, const char *head, const char *unit, int reps, const char *tail) {
+    strcpy(out, head);
+    for (int i = 0; i < reps; i++) {
+        strcat(out, unit);
+    }
+    strcat(out, tail);
+}
+
+// Edges the generator reaches only by luck
+static size_t add_fixed(fuzz_case_t *c) {
+    size_t n = 0;
+    int pairs = (MAX_TOKENS - 2) / 2; // "&B" pairs that fit after an "A"
+
+    fill_repeat(c[n++].text, "", "!", MAX_TOKENS - 2, "A"); // exactly at the token limit
+    fill_repeat(c[n++].text, "", "!", MAX_TOKENS - 1, "A"); // one over
+    fill_repeat(c[n++].text, "A", "&B", pairs, "");         // longest chain
+    fill_repeat(c[n++].text, "A", "&B", pairs - 1, "&");    // dangling operator
+    fill_repeat(c[n++].text, "", "(", (MAX_TOKENS - 2) / 2, "A"); // deepest nesting
+    for (int i = 0; i < (MAX_TOKENS - 2) / 2; i++) {
+        strcat(c[n - 1].text, ")");
+    }
+    fill_repeat(c[n++].text, " \t", "a | ", pairs, "c\r\n");
+    static const char *const small[] = {
+        "", " ", "A", "!", "()", "(A", "A)", "AB", "A!", "!A!", "A&&B", "a^b^c",
+        "D", "A&1", "A#B", "(A|B)&!C", "!(A&B)|(B^C)", "A^B&C|!A",
+    };
+    for (size_t i = 0; i < sizeof(small) / sizeof(small[0]); i++) {
+        strcpy(c[n++].text, small[i]);
+    }
+    return n;
+}
+#define FUZZ_FIXED_MAX 32
+
+// ---------------------------------------------------------
+// 3. DRIVER
+// ---------------------------------------------------------
+static const char *err_name(int err) {
+    static const char *const names[] = { "ok", "syntax", "unknown_char", "token_overflow",
+                                         "node_pool" };
+    return err >= 0 && err <= ERR_NODE_POOL ? names[err] : "?";
+}
+
+int main(int argc, char **argv) {
+    uint64_t seed = 1;
+    uint32_t count = 200000, near_pct = 30;
+    int depth = 6, max_tokens = MAX_TOKENS + 8;
+    const char *corpus_path = NULL;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:n:d:l:p:w:h")) != -1) {
+        switch (opt) {
+        case 's': seed = strtoull(optarg, NULL, 0); break;
+        case 'n': count = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'd': depth = atoi(optarg); break;
+        case 'l': max_tokens = atoi(optarg); break;
+        case 'p': near_pct = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'w': corpus_path = optarg; break;
+        default:
+            fprintf(stderr, "usage: fuzz [-s SEED] [-n COUNT] [-d DEPTH] [-l TOKENS] "
+                            "[-p NEAR_PCT] [-w FILE]\n");
+            return 2;
+        }
+    }
+    if (max_tokens < 1 || max_tokens > FUZZ_EXPR_MAX / 2) {
+        fprintf(stderr, "fuzz: -l must be 1..%d\n", FUZZ_EXPR_MAX / 2);
+        return 2;
+    }
+
+    fuzz_case_t *cases = calloc(FUZZ_FIXED_MAX + (size_t)count, sizeof(*cases));
+    if (!cases) {
+        fprintf(stderr, "fuzz: out of memory\n");
+        return 1;
+    }
+
+    exprgen_t g;
+    exprgen_init(&g, seed, depth, max_tokens);
+    size_t total = add_fixed(cases);
+    for (uint32_t i = 0; i < count; i++, total++) {
+        if (exprgen_rand(&g, 100) < near_pct) {
+            exprgen_near(&g, cases[total].text, FUZZ_EXPR_MAX);
+        }
+        else {
+            exprgen_valid(&g, cases[total].text, FUZZ_EXPR_MAX);
+        }
+    }
+
+    // Engine pass, timed on its own
+    uint64_t t0 = wall_ns();
+    for (size_t i = 0; i < total; i++) {
+        cases[i].err = build_truth_table(cases[i].text, &cases[i].table);
+    }
+    uint64_t engine_ns = wall_ns() - t0;
+
+    uint32_t by_err[ERR_NODE_POOL + 1] = { 0 };
+    uint32_t mismatches = 0;
+    t0 = wall_ns();
+    for (size_t i = 0; i < total; i++) {
+        const fuzz_case_t *c = &cases[i];
+        truth_table_t want = { 0 };
+        int ref = ref_eval(c->text, &want);
+        bool same = ref == -1 ? (c->err == ERR_SYNTAX || c->err == ERR_NODE_POOL)
+                              : ref == c->err && (ref != ERR_OK || want.bits == c->table.bits);
+        if (c->err >= 0 && c->err <= ERR_NODE_POOL) {
+            by_err[c->err]++;
+        }
+        if (!same && ++mismatches <= FUZZ_SHOW_MAX) {
+            printf("MISMATCH \"%s\": engine %s %02x, reference %s %02x\n", c->text,
+                   err_name(c->err), c->table.bits, ref == -1 ? "syntax|node_pool" : err_name(ref),
+                   want.bits);
+        }
+    }
+    uint64_t check_ns = wall_ns() - t0;
+
+    if (corpus_path) {
+        FILE *f = fopen(corpus_path, "w");
+        if (!f) {
+            perror(corpus_path);
+            return 1;
+        }
+        for (size_t i = 0; i < total; i++) {
+            // test_tt reads lines, so a case holding a line break is left out
+            if (!strpbrk(cases[i].text, "\r\n")) {
+                fprintf(f, "%s\n", cases[i].text);
+            }
+        }
+        fclose(f);
+    }
+
+    printf("seed %llu: %zu expressions (%zu fixed), depth %d, up to %d tokens, %u%% near-valid\n",
+           (unsigned long long)seed, total, total - count, depth, max_tokens, near_pct);
+    for (int e = 0; e <= ERR_NODE_POOL; e++) {
+        printf("  %-15s %u\n", err_name(e), by_err[e]);
+    }
+    printf("engine %.0f expr/s, with reference check %.0f expr/s\n",
+           total / (engine_ns / 1e9), total / ((engine_ns + check_ns) / 1e9));
+    printf("%u mismatches\n%s\n", mismatches, mismatches ? "FAIL" : "PASS");
+    free(cases);
+    return mismatches ? 1 : 0;
+}
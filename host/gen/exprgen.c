@@ -0,0 +1,147 @@
+#include "exprgen.h"
+#include <string.h>
+
+// Characters near-valid edits draw from: the grammar's own, blanks,
+// lower case, and a few the tokenizer rejects
+static const char edit_chars[] = "ABC!&|^()  abcD1#";
+
+typedef struct {
+    char *out;
+    size_t cap;
+    size_t len;
+    int tokens;
+    int budget;  // tokens this expression may use
+    int reserve; // closing parens still owed
+} gen_buf_t;
+
+void exprgen_init(exprgen_t *g, uint64_t seed, int max_depth, int max_tokens) {
+    g->state = seed;
+    g->max_depth = max_depth;
+    g->max_tokens = max_tokens;
+}
+
+// splitmix64
+static uint64_t next64(exprgen_t *g) {
+    uint64_t z = (g->state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+uint32_t exprgen_rand(exprgen_t *g, uint32_t n) {
+    return n ? (uint32_t)((next64(g) >> 32) % n) : 0;
+}
+
+// ---------------------------------------------------------
+// 1. VALID EXPRESSIONS
+// ---------------------------------------------------------
+static int room(const gen_buf_t *b) {
+    return b->budget - b->tokens - b->reserve;
+}
+
+static void put(exprgen_t *g, gen_buf_t *b, char c) {
+    if (exprgen_rand(g, 16) == 0 && b->len + 1 < b->cap) {
+        b->out[b->len++] = ' ';
+    }
+    if (b->len + 1 < b->cap) {
+        b->out[b->len++] = c;
+    }
+    b->tokens++;
+}
+
+static void gen_level(exprgen_t *g, gen_buf_t *b, int level, int depth);
+
+// factor := '!' factor | VAR | '(' expr ')'
+static void gen_factor(exprgen_t *g, gen_buf_t *b, int depth) {
+    uint32_t pick = depth > 0 ? exprgen_rand(g, 4) : 0;
+
+    if (pick == 1 && room(b) >= 2) {
+        put(g, b, '!');
+        gen_factor(g, b, depth - 1);
+    }
+    else if (pick >= 2 && room(b) >= 3) {
+        put(g, b, '(');
+        b->reserve++;
+        gen_level(g, b, 0, depth - 1);
+        b->reserve--;
+        put(g, b, ')');
+    }
+    else {
+        char v = (char)('A' + exprgen_rand(g, 3));
+        put(g, b, exprgen_rand(g, 8) == 0 ? (char)(v - 'A' + 'a') : v);
+    }
+}
+
+// Levels 0..2 are '|', '^', '&' chains; level 3 is a factor
+static void gen_level(exprgen_t *g, gen_buf_t *b, int level, int depth) {
+    static const char ops[] = "|^&";
+
+    if (level == 3) {
+        gen_factor(g, b, depth);
+        return;
+    }
+    gen_level(g, b, level + 1, depth);
+    while (room(b) >= 2 && exprgen_rand(g, 100) < 40) {
+        put(g, b, ops[level]);
+        gen_level(g, b, level + 1, depth);
+    }
+}
+
+size_t exprgen_valid(exprgen_t *g, char *out, size_t cap) {
+    gen_buf_t b = { out, cap, 0, 0, 1 + (int)exprgen_rand(g, (uint32_t)g->max_tokens), 0 };
+    gen_level(g, &b, 0, g->max_depth);
+    out[b.len] = '\0';
+    return b.len;
+}
+
+// ---------------------------------------------------------
+// 2. NEAR-VALID EXPRESSIONS
+// ---------------------------------------------------------
+static size_t edit(exprgen_t *g, char *s, size_t len, size_t cap) {
+    char c = edit_chars[exprgen_rand(g, sizeof(edit_chars) - 1)];
+    size_t at = exprgen_rand(g, (uint32_t)len + 1);
+
+    switch (exprgen_rand(g, 5)) {
+    case 0: // drop
+        if (at < len) {
+            memmove(s + at, s + at + 1, len - at);
+            return len - 1;
+        }
+        return len;
+    case 1: // insert
+        if (len + 1 < cap) {
+            memmove(s + at + 1, s + at, len - at + 1);
+            s[at] = c;
+            return len + 1;
+        }
+        return len;
+    case 2: // swap with the next one
+        if (at + 1 < len) {
+            char t = s[at];
+            s[at] = s[at + 1];
+            s[at + 1] = t;
+        }
+        return len;
+    case 3: // duplicate
+        if (at < len && len + 1 < cap) {
+            memmove(s + at + 1, s + at, len - at + 1);
+            return len + 1;
+        }
+        return len;
+    default: // replace
+        if (at < len) {
+            s[at] = c;
+        }
+        return len;
+    }
+}
+
+size_t exprgen_near(exprgen_t *g, char *out, size_t cap) {
+    size_t len = exprgen_valid(g, out, cap);
+    int edits = 1 + (int)exprgen_rand(g, 2);
+    for (int i = 0; i < edits; i++) {
+        len = edit(g, out, len, cap);
+    }
+    out[len] = '\0';
+    return len;
+}
@@ -0,0 +1,31 @@
+#include "host_hal.h"
+#include <stdlib.h>
+
+// Counts heap allocations made by the code under test. Linked with
+// -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc so calls from our
+// objects land here (allocations inside libc itself are not seen).
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t n, size_t size);
+void *__real_realloc(void *p, size_t size);
+
+static uint64_t alloc_count = 0;
+
+void *__wrap_malloc(size_t size) {
+    alloc_count++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t n, size_t size) {
+    alloc_count++;
+    return __real_calloc(n, size);
+}
+
+void *__wrap_realloc(void *p, size_t size) {
+    alloc_count++;
+    return __real_realloc(p, size);
+}
+
+uint64_t host_alloc_count(void) {
+    return alloc_count;
+}
@@ -0,0 +1,8 @@
+#include "pico/stdlib.h"
+
+// Board constants that main.c provides on the device
+const int SPI_DISP_DMA_CHANNEL = 5;
+const int SPI_DISP_SCK = 34;
+const int SPI_DISP_CSn = 33;
+const int SPI_DISP_TX = 35;
+const int KNOB_DMA_CHANNEL = 6;
@@ -0,0 +1,99 @@
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+#include "pico/flash.h"
+#include "host_hal.h"
+#include <assert.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// NOR flash as the SDK sees it: erase sets whole sectors to 0xFF,
+// programming can only clear bits, and both are page/sector aligned.
+
+#define FLASH_ERASE_US 45000u // 4 KiB sector erase, typical
+#define FLASH_PROGRAM_US 400u // 256 byte page program, typical
+#define FLASH_SECTORS (PICO_FLASH_SIZE_BYTES / FLASH_SECTOR_SIZE)
+
+static uint8_t *image = NULL;
+static uint32_t erases[FLASH_SECTORS];
+
+static void image_init(void) {
+    if (image == NULL) {
+        image = malloc(PICO_FLASH_SIZE_BYTES);
+        if (image == NULL) {
+            abort();
+        }
+        memset(image, 0xFF, PICO_FLASH_SIZE_BYTES);
+    }
+}
+
+const uint8_t *host_flash_image(void) {
+    image_init();
+    return image;
+}
+
+bool host_flash_attach(const char *path) {
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        perror(path);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || ftruncate(fd, PICO_FLASH_SIZE_BYTES) != 0) {
+        perror(path);
+        close(fd);
+        return false;
+    }
+    uint8_t *map = mmap(NULL, PICO_FLASH_SIZE_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror(path);
+        return false;
+    }
+    if ((size_t)st.st_size < PICO_FLASH_SIZE_BYTES) {
+        memset(map + st.st_size, 0xFF, PICO_FLASH_SIZE_BYTES - (size_t)st.st_size);
+    }
+    image = map;
+    return true;
+}
+
+uint32_t host_flash_erases(uint32_t flash_offs) {
+    return erases[flash_offs / FLASH_SECTOR_SIZE];
+}
+
+void flash_range_erase(uint32_t flash_offs, size_t count) {
+    assert(flash_offs % FLASH_SECTOR_SIZE == 0 && count % FLASH_SECTOR_SIZE == 0);
+    assert(flash_offs + count <= PICO_FLASH_SIZE_BYTES);
+    image_init();
+    memset(image + flash_offs, 0xFF, count);
+    for (size_t s = 0; s < count / FLASH_SECTOR_SIZE; s++) {
+        erases[flash_offs / FLASH_SECTOR_SIZE + s]++;
+    }
+    host_advance_us(FLASH_ERASE_US * (count / FLASH_SECTOR_SIZE));
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count) {
+    assert(flash_offs % FLASH_PAGE_SIZE == 0 && count % FLASH_PAGE_SIZE == 0);
+    assert(flash_offs + count <= PICO_FLASH_SIZE_BYTES);
+    image_init();
+    for (size_t i = 0; i < count; i++) {
+        image[flash_offs + i] &= data[i];
+    }
+    host_advance_us(FLASH_PROGRAM_US * (count / FLASH_PAGE_SIZE));
+}
+
+int flash_safe_execute(void (*func)(void *), void *param, uint32_t enter_exit_timeout_ms) {
+    (void)enter_exit_timeout_ms;
+    uint32_t irq = save_and_disable_interrupts();
+    func(param);
+    restore_interrupts(irq);
+    return PICO_OK;
+}
+
+bool flash_safe_execute_core_init(void) {
+    return true;
+}
@@ -0,0 +1,712 @@
+#include "pico/stdlib.h"
+#include "hardware/adc.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/spi.h"
+#include "hardware/uart.h"
+#include "host_hal.h"
+#include <stdio.h>
+#include <string.h>
+
+// Discrete-event model of the peripherals src/ touches. Simulated time
+// is kept in ns; it only moves in host_advance_us/host_idle, and each
+// step runs the earliest due event: an armed TIMER0 alarm, a repeating
+// timer, or one DMA element.
+
+#define NS_PER_US 1000u
+#define SPI_DR_IDLE 0xFFFFFFFFu // dr holds no unsent frame
+
+timer_hw_t host_timer_hw;
+sio_hw_t host_sio_hw;
+spi_hw_t host_spi0_hw = { .dr = SPI_DR_IDLE };
+adc_hw_t host_adc_hw;
+
+// ---------------------------------------------------------
+// 1. CLOCK AND INTERRUPTS
+// ---------------------------------------------------------
+static uint64_t now_ns = 0;
+static uint32_t clk_sys_hz = 150000000u;
+
+static irq_handler_t irq_handlers[HOST_NUM_IRQS];
+static uint64_t irq_enabled = 0;
+static uint64_t irq_pending = 0;
+static bool irq_masked = false;
+static bool in_isr = false;
+
+static void set_time(uint64_t t_ns) {
+    now_ns = t_ns;
+    uint64_t us = t_ns / NS_PER_US;
+    timer_hw->timerawl = (uint32_t)us;
+    timer_hw->timerawh = (uint32_t)(us >> 32);
+}
+
+static void run_pending(void) {
+    while (!irq_masked && !in_isr && (irq_pending & irq_enabled)) {
+        uint64_t ready = irq_pending & irq_enabled;
+        uint num = (uint)__builtin_ctzll(ready);
+        irq_pending &= ~(1ull << num);
+        if (irq_handlers[num]) {
+            in_isr = true;
+            irq_handlers[num]();
+            in_isr = false;
+        }
+    }
+}
+
+static void raise_irq(uint num) {
+    irq_pending |= 1ull << num;
+    run_pending();
+}
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler) {
+    irq_handlers[num] = handler;
+}
+
+void irq_set_enabled(uint num, bool enabled) {
+    if (enabled) {
+        irq_enabled |= 1ull << num;
+    }
+    else {
+        irq_enabled &= ~(1ull << num);
+    }
+    run_pending();
+}
+
+uint32_t save_and_disable_interrupts(void) {
+    uint32_t was = irq_masked;
+    irq_masked = true;
+    return was;
+}
+
+void restore_interrupts(uint32_t status) {
+    irq_masked = status != 0;
+    run_pending();
+}
+
+uint64_t host_now_ns(void) {
+    return now_ns;
+}
+
+uint32_t time_us_32(void) {
+    return (uint32_t)(now_ns / NS_PER_US);
+}
+
+uint64_t time_us_64(void) {
+    return now_ns / NS_PER_US;
+}
+
+uint32_t clock_get_hz(clock_num_t clock) {
+    switch (clock) {
+    case clk_sys:
+    case clk_peri: // runs from clk_sys, undivided
+        return clk_sys_hz;
+    case clk_usb:
+    case clk_adc:
+        return 48000000u;
+    case clk_ref:
+        return 12000000u;
+    default:
+        return 150000000u;
+    }
+}
+
+bool clock_configure(clock_num_t clock, uint32_t src, uint32_t auxsrc, uint32_t src_freq, uint32_t freq) {
+    (void)src;
+    (void)auxsrc;
+    if (freq == 0 || freq > src_freq) {
+        return false;
+    }
+    if (clock == clk_sys) {
+        clk_sys_hz = freq;
+    }
+    return true;
+}
+
+bool set_sys_clock_khz(uint32_t freq_khz, bool required) {
+    (void)required;
+    clk_sys_hz = freq_khz * 1000u;
+    return true;
+}
+
+// ---------------------------------------------------------
+// 2. GPIO, SPI AND ADC
+// ---------------------------------------------------------
+void gpio_init(uint gpio) {
+    sio_hw->gpio_oe &= ~(1u << gpio);
+    sio_hw->gpio_out &= ~(1u << gpio);
+}
+
+void gpio_set_dir(uint gpio, bool out) {
+    if (out) {
+        sio_hw->gpio_oe |= 1u << gpio;
+    }
+    else {
+        sio_hw->gpio_oe &= ~(1u << gpio);
+    }
+}
+
+void gpio_put(uint gpio, bool value) {
+    gpio_put_masked(1u << gpio, value ? 1u << gpio : 0);
+}
+
+bool gpio_get(uint gpio) {
+    return (sio_hw->gpio_in >> gpio) & 1u;
+}
+
+static host_gpio_out_hook_t gpio_out_hook = NULL;
+
+void gpio_put_masked(uint32_t mask, uint32_t value) {
+    sio_hw->gpio_out = (sio_hw->gpio_out & ~mask) | (value & mask);
+    if (gpio_out_hook) {
+        gpio_out_hook(sio_hw->gpio_out);
+    }
+}
+
+void gpio_pull_up(uint gpio) {
+    (void)gpio;
+}
+
+void gpio_pull_down(uint gpio) {
+    (void)gpio;
+}
+
+void gpio_set_function(uint gpio, enum gpio_function fn) {
+    (void)gpio;
+    (void)fn;
+}
+
+void host_gpio_set_in(uint32_t mask, uint32_t value) {
+    sio_hw->gpio_in = (sio_hw->gpio_in & ~mask) | (value & mask);
+}
+
+void host_gpio_set_out_hook(host_gpio_out_hook_t hook) {
+    gpio_out_hook = hook;
+}
+
+static host_spi_sink_t spi_sink = NULL;
+static uint spi_div = 150;  // clk_peri / SCK, fixed until set again
+static uint spi_bits = 8;
+
+// SCK follows clk_peri, so a clock change moves it until the divider
+// is set again
+static uint spi_baud(void) {
+    return clock_get_hz(clk_peri) / spi_div;
+}
+
+void host_spi_set_sink(host_spi_sink_t sink) {
+    spi_sink = sink;
+}
+
+static void spi_emit(uint16_t frame) {
+    if (spi_sink) {
+        spi_sink(frame, now_ns);
+    }
+}
+
+// CPU writes to dr are plain stores; pick them up whenever the model
+// gets control (send_spi_cmd always polls spi_is_writable first)
+static void spi_poll(void) {
+    if (host_spi0_hw.dr != SPI_DR_IDLE) {
+        uint16_t frame = (uint16_t)host_spi0_hw.dr;
+        host_spi0_hw.dr = SPI_DR_IDLE;
+        spi_emit(frame);
+    }
+}
+
+uint spi_init(spi_inst_t *spi, uint baudrate) {
+    (void)spi;
+    host_spi0_hw.dr = SPI_DR_IDLE;
+    return spi_set_baudrate(spi, baudrate);
+}
+
+uint spi_set_baudrate(spi_inst_t *spi, uint baudrate) {
+    (void)spi;
+    uint32_t peri = clock_get_hz(clk_peri);
+    spi_div = baudrate ? (peri + baudrate - 1) / baudrate : peri;
+    spi_div = spi_div < 2 ? 2 : spi_div;
+    return spi_baud();
+}
+
+uint spi_get_baudrate(const spi_inst_t *spi) {
+    (void)spi;
+    return spi_baud();
+}
+
+void spi_set_format(spi_inst_t *spi, uint data_bits, spi_cpol_t cpol, spi_cpha_t cpha, spi_order_t order) {
+    (void)spi;
+    (void)cpol;
+    (void)cpha;
+    (void)order;
+    spi_bits = data_bits;
+}
+
+bool spi_is_writable(const spi_inst_t *spi) {
+    (void)spi;
+    spi_poll();
+    return true;
+}
+
+bool spi_is_busy(const spi_inst_t *spi) {
+    (void)spi;
+    spi_poll();
+    return false;
+}
+
+uint spi_get_dreq(spi_inst_t *spi, bool is_tx) {
+    (void)spi;
+    return is_tx ? DREQ_SPI0_TX : DREQ_SPI0_TX + 1;
+}
+
+static uint16_t adc_values[8];
+static uint adc_input = 0;
+static float adc_clkdiv = 0.0f;
+
+void host_adc_set(unsigned input, uint16_t value) {
+    adc_values[input & 7] = value & 0x0FFFu;
+}
+
+void adc_init(void) {
+}
+
+void adc_gpio_init(uint gpio) {
+    (void)gpio;
+}
+
+void adc_select_input(uint input) {
+    adc_input = input & 7;
+}
+
+void adc_set_round_robin(uint input_mask) {
+    (void)input_mask; // one input in use: same as the selected one
+}
+
+void adc_fifo_setup(bool en, bool dreq_en, uint16_t dreq_thresh, bool err_in_fifo, bool byte_shift) {
+    (void)en;
+    (void)dreq_en;
+    (void)dreq_thresh;
+    (void)err_in_fifo;
+    (void)byte_shift;
+}
+
+void adc_set_clkdiv(float clkdiv) {
+    adc_clkdiv = clkdiv;
+}
+
+void adc_run(bool run) {
+    (void)run;
+}
+
+uint16_t adc_read(void) {
+    return adc_values[adc_input];
+}
+
+// ---------------------------------------------------------
+// 3. DMA
+// ---------------------------------------------------------
+typedef struct {
+    dma_channel_config cfg;
+    volatile uint8_t *write;
+    const volatile uint8_t *read;
+    uint32_t remaining;
+    bool endless;
+    bool busy;
+    bool irq0;
+    uint64_t next_ns; // next element
+} dma_chan_t;
+
+static dma_chan_t dma_chan[NUM_DMA_CHANNELS];
+static uint16_t dma_timer_num[NUM_DMA_TIMERS];
+static uint16_t dma_timer_den[NUM_DMA_TIMERS];
+
+static uint64_t dma_period_ns(const dma_chan_t *ch) {
+    uint dreq = ch->cfg.dreq;
+    if (dreq >= DREQ_DMA_TIMER0 && dreq < DREQ_DMA_TIMER0 + NUM_DMA_TIMERS) {
+        uint t = dreq - DREQ_DMA_TIMER0;
+        if (dma_timer_num[t] == 0) {
+            return UINT64_MAX / 2; // never fires
+        }
+        return (uint64_t)1000000000u * dma_timer_den[t] / ((uint64_t)dma_timer_num[t] * clk_sys_hz);
+    }
+    if (dreq == DREQ_ADC) {
+        return (uint64_t)(1000000000.0 * (1.0 + adc_clkdiv) / 48000000.0);
+    }
+    if (dreq == DREQ_SPI0_TX) {
+        return (uint64_t)1000000000u * spi_bits / spi_baud();
+    }
+    return 0; // unpaced
+}
+
+static void dma_element(uint c) {
+    dma_chan_t *ch = &dma_chan[c];
+    uint size = 1u << ch->cfg.size;
+    uint32_t value = 0;
+
+    if (ch->read == (const volatile uint8_t *)&adc_hw->fifo) {
+        value = adc_values[adc_input];
+    }
+    else {
+        memcpy(&value, (const void *)ch->read, size);
+    }
+
+    if (ch->write == (volatile uint8_t *)&host_spi0_hw.dr) {
+        spi_poll();
+        spi_emit((uint16_t)value);
+    }
+    else {
+        memcpy((void *)ch->write, &value, size);
+    }
+
+    if (ch->cfg.read_incr) {
+        ch->read += size;
+    }
+    if (ch->cfg.write_incr) {
+        ch->write += size;
+    }
+    if (ch->cfg.ring_bits) {
+        uintptr_t ring = (uintptr_t)1 << ch->cfg.ring_bits;
+        if (ch->cfg.ring_write && ((uintptr_t)ch->write & (ring - 1)) == 0) {
+            ch->write -= ring;
+        }
+        if (!ch->cfg.ring_write && ((uintptr_t)ch->read & (ring - 1)) == 0) {
+            ch->read -= ring;
+        }
+    }
+
+    if (!ch->endless && --ch->remaining == 0) {
+        ch->busy = false;
+        if (ch->irq0) {
+            raise_irq(DMA_IRQ_0);
+        }
+        return;
+    }
+    ch->next_ns += dma_period_ns(ch);
+}
+
+static void dma_trigger(uint c) {
+    dma_chan_t *ch = &dma_chan[c];
+    if (!ch->endless && ch->remaining == 0) {
+        return;
+    }
+    ch->busy = true;
+    ch->next_ns = now_ns + dma_period_ns(ch);
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel) {
+    (void)channel;
+    dma_channel_config c = {
+        .size = DMA_SIZE_32,
+        .read_incr = true,
+        .write_incr = false,
+        .dreq = DREQ_FORCE,
+        .ring_write = false,
+        .ring_bits = 0,
+    };
+    return c;
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size) {
+    c->size = (uint8_t)size;
+}
+
+void channel_config_set_read_increment(dma_channel_config *c, bool incr) {
+    c->read_incr = incr;
+}
+
+void channel_config_set_write_increment(dma_channel_config *c, bool incr) {
+    c->write_incr = incr;
+}
+
+void channel_config_set_dreq(dma_channel_config *c, uint dreq) {
+    c->dreq = (uint8_t)dreq;
+}
+
+void channel_config_set_ring(dma_channel_config *c, bool write, uint size_bits) {
+    c->ring_write = write;
+    c->ring_bits = (uint8_t)size_bits;
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint32_t transfer_count, bool trigger) {
+    dma_chan_t *ch = &dma_chan[channel];
+    ch->cfg = *config;
+    ch->write = (volatile uint8_t *)write_addr;
+    ch->read = (const volatile uint8_t *)read_addr;
+    ch->endless = (transfer_count >> 28) == 0xfu;
+    ch->remaining = transfer_count & 0x0FFFFFFFu;
+    ch->busy = false;
+    if (trigger) {
+        dma_trigger(channel);
+    }
+}
+
+void dma_channel_transfer_from_buffer_now(uint channel, const volatile void *read_addr, uint32_t transfer_count) {
+    dma_chan_t *ch = &dma_chan[channel];
+    ch->read = (const volatile uint8_t *)read_addr;
+    ch->endless = false;
+    ch->remaining = transfer_count;
+    dma_trigger(channel);
+}
+
+void dma_channel_start(uint channel) {
+    dma_trigger(channel);
+}
+
+void dma_channel_abort(uint channel) {
+    dma_chan[channel].busy = false;
+}
+
+bool dma_channel_is_busy(uint channel) {
+    return dma_chan[channel].busy;
+}
+
+void dma_channel_set_irq0_enabled(uint channel, bool enabled) {
+    dma_chan[channel].irq0 = enabled;
+}
+
+void dma_channel_acknowledge_irq0(uint channel) {
+    (void)channel;
+}
+
+void dma_timer_claim(uint timer) {
+    (void)timer;
+}
+
+void dma_timer_set_fraction(uint timer, uint16_t numerator, uint16_t denominator) {
+    dma_timer_num[timer] = numerator;
+    dma_timer_den[timer] = denominator;
+}
+
+uint dma_get_timer_dreq(uint timer) {
+    return DREQ_DMA_TIMER0 + timer;
+}
+
+// ---------------------------------------------------------
+// 4. EVENT SCHEDULER
+// ---------------------------------------------------------
+static uint32_t alarm_seen[4]; // last value written, to spot re-arming
+static struct repeating_timer *rt_list = NULL;
+
+// A store to an alarm register arms it
+static void timer_poll(void) {
+    for (int i = 0; i < 4; i++) {
+        if (timer_hw->alarm[i] != alarm_seen[i]) {
+            alarm_seen[i] = timer_hw->alarm[i];
+            timer_hw->armed |= 1u << i;
+        }
+    }
+}
+
+static uint64_t alarm_due_ns(int i) {
+    int32_t ahead = (int32_t)(timer_hw->alarm[i] - time_us_32());
+    if (ahead <= 0) {
+        return now_ns;
+    }
+    return (now_ns / NS_PER_US + (uint32_t)ahead) * NS_PER_US;
+}
+
+static void repeating_timer_isr(void) {
+    uint64_t now_us = now_ns / NS_PER_US;
+    for (struct repeating_timer **p = &rt_list; *p != NULL;) {
+        struct repeating_timer *t = *p;
+        if (t->next_us <= now_us) {
+            if (!t->callback(t)) {
+                *p = t->next;
+                continue;
+            }
+            t->next_us += (uint64_t)(t->delay_us < 0 ? -t->delay_us : t->delay_us);
+        }
+        p = &t->next;
+    }
+}
+
+bool add_repeating_timer_ms(int32_t delay_ms, repeating_timer_callback_t callback,
+                            void *user_data, struct repeating_timer *out) {
+    out->delay_us = (int64_t)delay_ms * 1000;
+    out->next_us = now_ns / NS_PER_US + (uint64_t)(delay_ms < 0 ? -delay_ms : delay_ms) * 1000u;
+    out->callback = callback;
+    out->user_data = user_data;
+    out->next = rt_list;
+    rt_list = out;
+
+    // The SDK alarm pool owns TIMER0 alarm 3
+    irq_set_exclusive_handler(TIMER0_IRQ_3, repeating_timer_isr);
+    irq_set_enabled(TIMER0_IRQ_3, true);
+    return true;
+}
+
+// Run the earliest event due at or before limit_ns. Returns false (and
+// leaves the clock alone) if there is none.
+static bool run_next_event(uint64_t limit_ns) {
+    spi_poll();
+    timer_poll();
+
+    uint64_t best = UINT64_MAX;
+    int kind = -1; // 0..3 alarm, 4 repeating timer, 5 + c DMA channel c
+
+    for (int i = 0; i < 4; i++) {
+        if ((timer_hw->armed & (1u << i)) && alarm_due_ns(i) < best) {
+            best = alarm_due_ns(i);
+            kind = i;
+        }
+    }
+    // Once raised, the pool's IRQ stays pending until it can be taken
+    // (interrupts masked, e.g. around a flash write); raising it again
+    // would not move next_us and time would stand still
+    bool rt_pending = (irq_pending >> TIMER0_IRQ_3) & 1u;
+    for (struct repeating_timer *t = rt_list; t != NULL && !rt_pending; t = t->next) {
+        if (t->next_us * NS_PER_US < best) {
+            best = t->next_us * NS_PER_US;
+            kind = 4;
+        }
+    }
+    for (int c = 0; c < NUM_DMA_CHANNELS; c++) {
+        if (dma_chan[c].busy && dma_chan[c].next_ns < best) {
+            best = dma_chan[c].next_ns;
+            kind = 5 + c;
+        }
+    }
+
+    if (kind < 0 || best > limit_ns) {
+        return false;
+    }
+    if (best > now_ns) {
+        set_time(best);
+    }
+
+    if (kind < 4) {
+        timer_hw->armed &= ~(1u << kind);
+        timer_hw->intr |= 1u << kind;
+        if (timer_hw->inte & (1u << kind)) {
+            raise_irq(TIMER0_IRQ_0 + (uint)kind);
+        }
+    }
+    else if (kind == 4) {
+        raise_irq(TIMER0_IRQ_3);
+    }
+    else {
+        dma_element((uint)(kind - 5));
+    }
+
+    spi_poll();
+    timer_poll();
+    return true;
+}
+
+void host_advance_us(uint64_t us) {
+    uint64_t target = now_ns + us * NS_PER_US;
+    while (run_next_event(target)) {
+    }
+    set_time(target);
+}
+
+void host_idle(void) {
+    // Nothing scheduled: let a millisecond pass so polling loops that
+    // wait on time_us_* still make progress
+    if (!run_next_event(UINT64_MAX)) {
+        set_time(now_ns + 1000u * NS_PER_US);
+    }
+}
+
+bool host_run_until(bool (*done)(void), uint64_t max_us) {
+    uint64_t limit = now_ns + max_us * NS_PER_US;
+    while (!done()) {
+        if (!run_next_event(limit)) {
+            set_time(limit);
+            return done();
+        }
+    }
+    return true;
+}
+
+void sleep_us(uint64_t us) {
+    host_advance_us(us);
+}
+
+void sleep_ms(uint32_t ms) {
+    host_advance_us((uint64_t)ms * 1000u);
+}
+
+// ---------------------------------------------------------
+// 5. STDIO
+// ---------------------------------------------------------
+#define HOST_STDIN_LEN 4096
+
+static char stdin_ring[HOST_STDIN_LEN];
+static uint32_t stdin_head = 0;
+static uint32_t stdin_tail = 0;
+static void (*chars_available_cb)(void *) = NULL;
+static void *chars_available_param = NULL;
+static host_stdout_sink_t stdout_sink = NULL;
+
+// Console UART divisor, 16.6 fixed point as in the PL011 IBRD/FBRD
+uint32_t host_uart0;
+static uint32_t uart_div = 0;
+
+static uint32_t uart_baud(void) {
+    return uart_div ? (uint32_t)(4ull * clock_get_hz(clk_peri) / uart_div) : 0;
+}
+
+uint uart_set_baudrate(uart_inst_t *uart, uint baudrate) {
+    (void)uart;
+    uint32_t div = (uint32_t)(8ull * clock_get_hz(clk_peri) / baudrate);
+    uint32_t ibrd = div >> 7;
+    uint32_t fbrd = ((div & 0x7f) + 1) / 2;
+    if (ibrd == 0) {
+        ibrd = 1;
+        fbrd = 0;
+    }
+    else if (ibrd >= 65535) {
+        ibrd = 65535;
+        fbrd = 0;
+    }
+    uart_div = (ibrd << 6) + fbrd;
+    return uart_baud();
+}
+
+uint32_t host_uart_baud(void) {
+    return uart_baud();
+}
+
+bool stdio_init_all(void) {
+    host_spi0_hw.dr = SPI_DR_IDLE;
+    uart_set_baudrate(uart_default, PICO_DEFAULT_UART_BAUD_RATE);
+    return true;
+}
+
+void host_stdin_push(const char *data, size_t len) {
+    for (size_t i = 0; i < len && stdin_head - stdin_tail < HOST_STDIN_LEN; i++) {
+        stdin_ring[stdin_head++ % HOST_STDIN_LEN] = data[i];
+    }
+    if (chars_available_cb) {
+        chars_available_cb(chars_available_param);
+    }
+}
+
+int getchar_timeout_us(uint32_t timeout_us) {
+    (void)timeout_us;
+    if (stdin_tail == stdin_head) {
+        return PICO_ERROR_TIMEOUT;
+    }
+    return (unsigned char)stdin_ring[stdin_tail++ % HOST_STDIN_LEN];
+}
+
+void host_stdout_set_sink(host_stdout_sink_t sink) {
+    stdout_sink = sink;
+}
+
+int putchar_raw(int c) {
+    if (stdout_sink) {
+        stdout_sink((char)c);
+        return c;
+    }
+    return putchar(c);
+}
+
+void stdio_flush(void) {
+    fflush(stdout);
+}
+
+void stdio_set_chars_available_callback(void (*fn)(void *), void *param) {
+    chars_available_cb = fn;
+    chars_available_param = param;
+}
@@ -0,0 +1,156 @@
+#include "hd44780.h"
+#include "host_hal.h"
+#include "hardware/spi.h"
+#include <string.h>
+
+static char ddram[2][HD_DDRAM_COLS];
+static int ac_row = 0;
+static int ac_col = 0;
+static int shift = 0;
+static bool increment = true;
+static bool shift_on_write = false;
+static bool display_on = false;
+static bool cursor_on = false;
+static uint64_t busy_until_ns = 0;
+static hd_stats_t stats;
+
+void hd_reset(void) {
+    memset(ddram, ' ', sizeof(ddram));
+    ac_row = ac_col = 0;
+    shift = 0;
+    increment = true;
+    shift_on_write = false;
+    display_on = cursor_on = false;
+    busy_until_ns = 0;
+    memset(&stats, 0, sizeof(stats));
+}
+
+// In 2-line mode the address counter runs 0x00..0x27, 0x40..0x67
+static void ac_step(void) {
+    if (increment) {
+        if (++ac_col == HD_DDRAM_COLS) {
+            ac_col = 0;
+            ac_row ^= 1;
+        }
+    }
+    else {
+        if (--ac_col < 0) {
+            ac_col = HD_DDRAM_COLS - 1;
+            ac_row ^= 1;
+        }
+    }
+}
+
+static void display_shift(bool right) {
+    // Shifting the display right moves the view left
+    shift = (shift + (right ? HD_DDRAM_COLS - 1 : 1)) % HD_DDRAM_COLS;
+}
+
+static uint64_t command(uint8_t cmd) {
+    stats.commands++;
+
+    if (cmd & 0x80) {
+        uint8_t addr = cmd & 0x7F;
+        ac_row = addr >= 0x40;
+        ac_col = (addr & 0x3F) % HD_DDRAM_COLS;
+    }
+    else if (cmd & 0x40) {
+        // CGRAM address: custom glyphs are not modelled
+    }
+    else if (cmd & 0x20) {
+        // Function set: the model is always 2-line
+    }
+    else if (cmd & 0x10) {
+        if (cmd & 0x08) {
+            display_shift(cmd & 0x04);
+        }
+        else {
+            ac_col = (ac_col + ((cmd & 0x04) ? 1 : HD_DDRAM_COLS - 1)) % HD_DDRAM_COLS;
+        }
+    }
+    else if (cmd & 0x08) {
+        display_on = cmd & 0x04;
+        cursor_on = cmd & 0x02;
+    }
+    else if (cmd & 0x04) {
+        increment = cmd & 0x02;
+        shift_on_write = cmd & 0x01;
+    }
+    else if (cmd & 0x02) {
+        ac_row = ac_col = 0;
+        shift = 0;
+        stats.slow++;
+        return HD_EXEC_SLOW_NS;
+    }
+    else if (cmd & 0x01) {
+        memset(ddram, ' ', sizeof(ddram));
+        ac_row = ac_col = 0;
+        shift = 0;
+        increment = true;
+        stats.slow++;
+        return HD_EXEC_SLOW_NS;
+    }
+    return HD_EXEC_NS;
+}
+
+static uint64_t data(uint8_t c) {
+    stats.data++;
+    ddram[ac_row][ac_col] = (char)c;
+    ac_step();
+    if (shift_on_write) {
+        display_shift(!increment);
+    }
+    return HD_EXEC_NS;
+}
+
+static void hd_frame(uint16_t frame, uint64_t t_ns) {
+    uint64_t wire_ns = 9ull * 1000000000u / spi_get_baudrate(spi0);
+
+    stats.frames++;
+    stats.bus_ns += wire_ns;
+    if (t_ns < busy_until_ns) {
+        stats.violations++;
+    }
+
+    uint64_t exec_ns = (frame & 0x100) ? data((uint8_t)frame) : command((uint8_t)frame);
+    busy_until_ns = t_ns + wire_ns + exec_ns;
+    stats.last_done_ns = busy_until_ns;
+}
+
+// Attaching is power-on: the controller ignores input until its
+// internal reset has finished
+void hd_attach(void) {
+    hd_reset();
+    busy_until_ns = host_now_ns() + HD_POWER_ON_NS;
+    host_spi_set_sink(hd_frame);
+}
+
+void hd_get_stats(hd_stats_t *out) {
+    *out = stats;
+}
+
+void hd_visible_row(int row, char out[17]) {
+    for (int c = 0; c < 16; c++) {
+        out[c] = ddram[row][(shift + c) % HD_DDRAM_COLS];
+    }
+    out[16] = '\0';
+}
+
+char hd_ddram(int row, int col) {
+    return ddram[row][col];
+}
+
+int hd_shift(void) {
+    return shift;
+}
+
+bool hd_display_on(void) {
+    return display_on;
+}
+
+bool hd_cursor(int *row, int *col) {
+    int vis = (ac_col - shift + HD_DDRAM_COLS) % HD_DDRAM_COLS;
+    *row = ac_row;
+    *col = vis;
+    return display_on && cursor_on && vis < 16;
+}
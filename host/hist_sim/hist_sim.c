@@ -0,0 +1,175 @@
+#include "pico/stdlib.h"
+#include "hardware/flash.h"
+#include "host_hal.h"
+#include "history.h"
+#include "outputbuilder.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Flash history soak on the flash stand-in. Appends a long run of
+// expressions with typing-like gaps between them, checks the recall
+// index against what went in, remounts as after a reset and checks
+// again, then reports page writes, the worst write stall and the
+// erase count of every sector in the region (the wear spread). A 10 ms
+// repeating timer runs throughout, as the UI tick does on the device,
+// and must not lose ticks to the interrupts-off page writes. Any
+// mismatch makes the run fail.
+//
+//   hist_sim [-n COUNT] [FLASH_FILE]   FILE keeps the flash between runs
+
+#define SIM_KEY_GAP_US 150000u  // between keys while typing
+#define SIM_KEYS_PER_EXPR 4
+#define SIM_PAUSE_US 1500000u   // every SIM_PAUSE_EVERY entries: long enough to write
+#define SIM_PAUSE_EVERY 5
+#define SIM_SHORT_US 300000u
+#define SIM_STEP_US 10000u      // UI tick
+#define SIM_TICK_MS 10
+
+static const char *const corpus[] = {
+    "A", "!A", "A&B", "A|B&C", "A^B^C", "(A|B)&!C", "!(A&B)|(B^C)",
+    "((A|B)&(B|C))^!(A&C)", "!!!A&!!B|!!!C",
+};
+#define CORPUS_LEN (sizeof(corpus) / sizeof(corpus[0]))
+
+typedef struct {
+    char expr[64];
+    truth_table_t table;
+} sim_entry_t;
+
+static sim_entry_t recent[HIST_INDEX_LEN]; // ring of the last appends
+static uint32_t appended = 0;
+static uint32_t worst_stall_us = 0;
+static uint32_t last_pages = 0;
+static uint32_t ticks = 0;
+
+static bool tick_cb(struct repeating_timer *t) {
+    (void)t;
+    ticks++;
+    return true;
+}
+
+// Distinct expressions: corpus entries with a varying tail
+static void make_entry(uint32_t i, sim_entry_t *e) {
+    snprintf(e->expr, sizeof(e->expr), "%s", corpus[i % CORPUS_LEN]);
+    for (uint32_t k = 0; k < (i / CORPUS_LEN) % 5; k++) {
+        strncat(e->expr, k & 1 ? "|C" : "&B", sizeof(e->expr) - strlen(e->expr) - 1);
+    }
+    build_truth_table(e->expr, &e->table);
+}
+
+// Let simulated time pass with the UI tick calling the service
+static void run_for(uint32_t us) {
+    for (uint32_t t = 0; t < us; t += SIM_STEP_US) {
+        host_advance_us(SIM_STEP_US);
+        history_service();
+
+        hist_stats_t st;
+        history_get_stats(&st);
+        if (st.pages_written != last_pages) {
+            last_pages = st.pages_written;
+            if (st.flush_us > worst_stall_us) {
+                worst_stall_us = st.flush_us;
+            }
+        }
+    }
+}
+
+static bool check_index(const char *when) {
+    uint32_t want = appended < HIST_INDEX_LEN ? appended : HIST_INDEX_LEN;
+    bool ok = true;
+
+    if ((uint32_t)history_count() < want) {
+        printf("FAIL %s: %d entries indexed, want at least %lu\n", when, history_count(),
+               (unsigned long)want);
+        ok = false;
+    }
+    for (uint32_t n = 0; n < want; n++) {
+        const sim_entry_t *e = &recent[(appended - 1 - n) % HIST_INDEX_LEN];
+        hist_entry_t h;
+        if (!history_get((int)n, &h) || h.len != strlen(e->expr)
+            || memcmp(h.expr, e->expr, h.len) != 0 || h.table.bits != e->table.bits) {
+            printf("FAIL %s: entry %lu is not \"%s\" %02x\n", when, (unsigned long)n, e->expr,
+                   e->table.bits);
+            ok = false;
+            break;
+        }
+    }
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    uint32_t count = 1000;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:h")) != -1) {
+        if (opt == 'n') {
+            count = (uint32_t)strtoul(optarg, NULL, 0);
+        }
+        else {
+            fprintf(stderr, "usage: hist_sim [-n COUNT] [FLASH_FILE]\n");
+            return 2;
+        }
+    }
+    if (optind < argc && !host_flash_attach(argv[optind])) {
+        return 1;
+    }
+
+    static struct repeating_timer tick_timer;
+    add_repeating_timer_ms(SIM_TICK_MS, tick_cb, NULL, &tick_timer);
+    uint64_t t0_us = time_us_64();
+
+    history_init();
+    printf("mounted: %d entries\n", history_count());
+
+    for (uint32_t i = 0; i < count; i++) {
+        for (int k = 0; k < SIM_KEYS_PER_EXPR; k++) {
+            history_note_input();
+            run_for(SIM_KEY_GAP_US);
+        }
+        sim_entry_t *e = &recent[appended % HIST_INDEX_LEN];
+        make_entry(i, e);
+        history_append(e->expr, e->table);
+        appended++;
+        run_for(i % SIM_PAUSE_EVERY == SIM_PAUSE_EVERY - 1 ? SIM_PAUSE_US : SIM_SHORT_US);
+    }
+
+    bool ok = check_index("before reset");
+    history_flush();
+    hist_stats_t st;
+    history_get_stats(&st);
+    history_init();
+    ok &= check_index("after reset");
+
+    printf("appended %lu, %d indexed after remount, %lu dropped\n", (unsigned long)appended,
+           history_count(), (unsigned long)st.dropped);
+    printf("pages written %lu (%.1f records/page), worst write stall %lu us\n",
+           (unsigned long)st.pages_written,
+           st.pages_written ? (double)appended / st.pages_written : 0.0,
+           (unsigned long)worst_stall_us);
+
+    uint32_t want_ticks = (uint32_t)((time_us_64() - t0_us) / (SIM_TICK_MS * 1000u));
+    printf("ticks %lu of %lu\n", (unsigned long)ticks, (unsigned long)want_ticks);
+    if (ticks + 1 < want_ticks) {
+        printf("FAIL tick: %lu lost\n", (unsigned long)(want_ticks - ticks));
+        ok = false;
+    }
+
+    uint32_t base = PICO_FLASH_SIZE_BYTES - HIST_SECTORS * FLASH_SECTOR_SIZE;
+    uint32_t lo = UINT32_MAX, hi = 0;
+    printf("erases per sector:");
+    for (uint32_t s = 0; s < HIST_SECTORS; s++) {
+        uint32_t n = host_flash_erases(base + s * FLASH_SECTOR_SIZE);
+        lo = n < lo ? n : lo;
+        hi = n > hi ? n : hi;
+        printf(" %lu", (unsigned long)n);
+    }
+    printf("\n");
+    if (hi > lo + 1) {
+        printf("FAIL wear: erase counts differ by %lu\n", (unsigned long)(hi - lo));
+        ok = false;
+    }
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,34 @@
+#ifndef EXPRGEN_H
+#define EXPRGEN_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Seeded random expression generator for the fuzzer and benchmarks.
+// Valid output follows the evaluator's grammar
+//
+//   expr := xor { '|' xor }   xor := term { '^' term }
+//   term := factor { '&' factor }
+//   factor := '!' factor | VAR | '(' expr ')'
+//
+// with occasional blanks and lower-case variables. Near-valid output
+// is a valid expression with one or two small edits (a character
+// dropped, swapped, duplicated or replaced, possibly by one the
+// tokenizer rejects), so it lands on the boundary between accepted and
+// rejected input. The same seed always gives the same sequence.
+
+typedef struct {
+    uint64_t state;
+    int max_depth;  // nesting depth of factors
+    int max_tokens; // upper bound on tokens per expression
+} exprgen_t;
+
+void exprgen_init(exprgen_t *g, uint64_t seed, int max_depth, int max_tokens);
+uint32_t exprgen_rand(exprgen_t *g, uint32_t n); // uniform in [0, n)
+
+// Write one expression into out (always NUL-terminated); returns length
+size_t exprgen_valid(exprgen_t *g, char *out, size_t cap);
+size_t exprgen_near(exprgen_t *g, char *out, size_t cap);
+
+#endif
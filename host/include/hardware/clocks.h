@@ -0,0 +1,29 @@
+#ifndef HOST_HARDWARE_CLOCKS_H
+#define HOST_HARDWARE_CLOCKS_H
+
+#include "pico.h"
+
+typedef enum clock_num_rp2350 {
+    clk_gpout0 = 0,
+    clk_gpout1,
+    clk_gpout2,
+    clk_gpout3,
+    clk_ref,
+    clk_sys,
+    clk_peri,
+    clk_hstx,
+    clk_usb,
+    clk_adc,
+    CLK_COUNT
+} clock_num_t;
+
+// Source selections the firmware uses (values as in hardware/regs/clocks.h)
+#define CLOCKS_CLK_SYS_CTRL_SRC_VALUE_CLKSRC_CLK_SYS_AUX 0x1u
+#define CLOCKS_CLK_SYS_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS 0x0u
+#define CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLK_SYS 0x0u
+
+uint32_t clock_get_hz(clock_num_t clock);
+bool clock_configure(clock_num_t clock, uint32_t src, uint32_t auxsrc, uint32_t src_freq, uint32_t freq);
+bool set_sys_clock_khz(uint32_t freq_khz, bool required);
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef HOST_HARDWARE_DMA_H
+#define HOST_HARDWARE_DMA_H
+
+#include "pico.h"
+
+// DMA channels copy one element per DREQ period of simulated time:
+// DMA timers pace by their fraction of clk_sys, DREQ_ADC by the ADC
+// conversion rate, DREQ_SPI0_TX by the frame wire time. Completion
+// raises DMA_IRQ_0 for channels with IRQ0 enabled.
+#define NUM_DMA_CHANNELS 16
+#define NUM_DMA_TIMERS 4
+
+enum {
+    DREQ_SPI0_TX = 24,
+    DREQ_ADC = 48,
+    DREQ_DMA_TIMER0 = 59,
+    DREQ_FORCE = 63,
+};
+
+enum dma_channel_transfer_size {
+    DMA_SIZE_8 = 0,
+    DMA_SIZE_16 = 1,
+    DMA_SIZE_32 = 2,
+};
+
+typedef struct {
+    uint8_t size;      // enum dma_channel_transfer_size
+    bool read_incr;
+    bool write_incr;
+    uint8_t dreq;
+    bool ring_write;
+    uint8_t ring_bits; // 0 = no ring
+} dma_channel_config;
+
+dma_channel_config dma_channel_get_default_config(uint channel);
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size);
+void channel_config_set_read_increment(dma_channel_config *c, bool incr);
+void channel_config_set_write_increment(dma_channel_config *c, bool incr);
+void channel_config_set_dreq(dma_channel_config *c, uint dreq);
+void channel_config_set_ring(dma_channel_config *c, bool write, uint size_bits);
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint32_t transfer_count, bool trigger);
+void dma_channel_transfer_from_buffer_now(uint channel, const volatile void *read_addr, uint32_t transfer_count);
+void dma_channel_start(uint channel);
+void dma_channel_abort(uint channel);
+bool dma_channel_is_busy(uint channel);
+void dma_channel_set_irq0_enabled(uint channel, bool enabled);
+void dma_channel_acknowledge_irq0(uint channel);
+
+void dma_timer_claim(uint timer);
+void dma_timer_set_fraction(uint timer, uint16_t numerator, uint16_t denominator);
+uint dma_get_timer_dreq(uint timer);
+
+static inline uint32_t dma_encode_endless_transfer_count(void) {
+    return 0xfu << 28;
+}
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef HOST_HARDWARE_FLASH_H
+#define HOST_HARDWARE_FLASH_H
+
+#include "pico.h"
+
+// On the host, "flash" is a memory image (optionally backed by a file,
+// see host_flash_attach). XIP_BASE maps it for reads, as the XIP window
+// does on the device.
+
+#define FLASH_PAGE_SIZE (1u << 8)
+#define FLASH_SECTOR_SIZE (1u << 12)
+
+#define XIP_BASE ((uintptr_t)host_flash_image())
+const uint8_t *host_flash_image(void);
+
+void flash_range_erase(uint32_t flash_offs, size_t count);
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count);
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef HOST_HARDWARE_GPIO_H
+#define HOST_HARDWARE_GPIO_H
+
+#include "pico.h"
+
+enum gpio_function {
+    GPIO_FUNC_SPI = 1,
+    GPIO_FUNC_UART = 2,
+    GPIO_FUNC_SIO = 5,
+    GPIO_FUNC_NULL = 0x1f,
+};
+
+typedef struct {
+    volatile uint32_t cpuid;
+    volatile uint32_t gpio_in;   // set by the host (host_gpio_set_in)
+    volatile uint32_t gpio_hi_in;
+    volatile uint32_t gpio_out;
+    volatile uint32_t gpio_oe;
+} sio_hw_t;
+
+extern sio_hw_t host_sio_hw;
+#define sio_hw (&host_sio_hw)
+
+void gpio_init(uint gpio);
+void gpio_set_dir(uint gpio, bool out);
+void gpio_put(uint gpio, bool value);
+bool gpio_get(uint gpio);
+void gpio_put_masked(uint32_t mask, uint32_t value);
+void gpio_pull_up(uint gpio);
+void gpio_pull_down(uint gpio);
+void gpio_set_function(uint gpio, enum gpio_function fn);
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef HOST_HARDWARE_IRQ_H
+#define HOST_HARDWARE_IRQ_H
+
+#include "pico.h"
+
+// RP2350 IRQ numbers
+enum {
+    TIMER0_IRQ_0 = 0,
+    TIMER0_IRQ_1 = 1,
+    TIMER0_IRQ_2 = 2,
+    TIMER0_IRQ_3 = 3,
+    DMA_IRQ_0 = 10,
+    DMA_IRQ_1 = 11,
+    SIO_IRQ_FIFO = 25,
+    ADC_IRQ_FIFO = 35,
+    HOST_NUM_IRQS = 52,
+};
+
+typedef void (*irq_handler_t)(void);
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler);
+void irq_set_enabled(uint num, bool enabled);
+
+#endif
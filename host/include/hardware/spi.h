@@ -0,0 +1,41 @@
+#ifndef HOST_HARDWARE_SPI_H
+#define HOST_HARDWARE_SPI_H
+
+#include "pico.h"
+
+// Frames written to dr (directly or by DMA) go to the host SPI sink
+typedef struct {
+    volatile uint32_t cr0;
+    volatile uint32_t cr1;
+    volatile uint32_t dr;
+    volatile uint32_t sr;
+    volatile uint32_t cpsr;
+    volatile uint32_t imsc;
+    volatile uint32_t ris;
+    volatile uint32_t mis;
+    volatile uint32_t icr;
+    volatile uint32_t dmacr;
+} spi_hw_t;
+
+typedef struct spi_inst spi_inst_t;
+
+extern spi_hw_t host_spi0_hw;
+#define spi0 ((spi_inst_t *)&host_spi0_hw)
+
+typedef enum { SPI_CPOL_0 = 0, SPI_CPOL_1 = 1 } spi_cpol_t;
+typedef enum { SPI_CPHA_0 = 0, SPI_CPHA_1 = 1 } spi_cpha_t;
+typedef enum { SPI_LSB_FIRST = 0, SPI_MSB_FIRST = 1 } spi_order_t;
+
+static inline spi_hw_t *spi_get_hw(spi_inst_t *spi) {
+    return (spi_hw_t *)spi;
+}
+
+uint spi_init(spi_inst_t *spi, uint baudrate);
+uint spi_set_baudrate(spi_inst_t *spi, uint baudrate);
+uint spi_get_baudrate(const spi_inst_t *spi);
+void spi_set_format(spi_inst_t *spi, uint data_bits, spi_cpol_t cpol, spi_cpha_t cpha, spi_order_t order);
+bool spi_is_writable(const spi_inst_t *spi);
+bool spi_is_busy(const spi_inst_t *spi);
+uint spi_get_dreq(spi_inst_t *spi, bool is_tx);
+
+#endif
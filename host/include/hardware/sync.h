@@ -0,0 +1,29 @@
+#ifndef HOST_HARDWARE_SYNC_H
+#define HOST_HARDWARE_SYNC_H
+
+#include "pico.h"
+
+// Interrupt masking is modelled: handlers raised while masked run when
+// the mask is restored, like a pended NVIC interrupt
+uint32_t save_and_disable_interrupts(void);
+void restore_interrupts(uint32_t status);
+
+void host_idle(void);
+
+// WFI/WFE sleep until the next simulated event
+static inline void __wfi(void) {
+    host_idle();
+}
+
+static inline void __wfe(void) {
+    host_idle();
+}
+
+static inline void __sev(void) {
+}
+
+static inline void __dmb(void) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+#endif
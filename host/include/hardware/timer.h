@@ -0,0 +1,25 @@
+#ifndef HOST_HARDWARE_TIMER_H
+#define HOST_HARDWARE_TIMER_H
+
+#include "pico.h"
+
+// TIMER0 register block. timerawh/timerawl follow the simulated clock;
+// writing an alarm arms it and it fires TIMER0_IRQ_n if enabled in inte.
+typedef struct {
+    volatile uint32_t alarm[4];
+    volatile uint32_t armed;
+    volatile uint32_t timerawh;
+    volatile uint32_t timerawl;
+    volatile uint32_t intr;
+    volatile uint32_t inte;
+    volatile uint32_t intf;
+    volatile uint32_t ints;
+} timer_hw_t;
+
+extern timer_hw_t host_timer_hw;
+#define timer_hw (&host_timer_hw)
+
+uint32_t time_us_32(void);
+uint64_t time_us_64(void);
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef HOST_HARDWARE_UART_H
+#define HOST_HARDWARE_UART_H
+
+#include "pico.h"
+
+// The console UART behind stdio. Only the baud divisor is modelled:
+// the rate follows clk_peri until the divisor is set again
+// (host_uart_baud in host_hal.h reads the rate on the wire).
+typedef struct uart_inst uart_inst_t;
+
+extern uint32_t host_uart0;
+#define uart0 ((uart_inst_t *)&host_uart0)
+#define uart_default uart0
+
+#ifndef PICO_DEFAULT_UART_BAUD_RATE
+#define PICO_DEFAULT_UART_BAUD_RATE 115200
+#endif
+
+uint uart_set_baudrate(uart_inst_t *uart, uint baudrate);
+
+// Output is written straight through, so the FIFO is always empty
+static inline void uart_tx_wait_blocking(uart_inst_t *uart) {
+    (void)uart;
+}
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef HD44780_H
+#define HD44780_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// HD44780-style controller model on the host SPI sink. It decodes the
+// 9-bit frames chardisp sends (bit 8 set = data write, clear = command)
+// into DDRAM, address counter, display shift and cursor state, and
+// accounts wire time and busy-time violations.
+
+#define HD_DDRAM_COLS 40
+#define HD_EXEC_NS 37000u      // most commands and data writes
+#define HD_EXEC_SLOW_NS 1520000u // clear display, return home
+#define HD_POWER_ON_NS 40000000u // after Vcc rises, before the first command
+
+typedef struct {
+    uint32_t frames;
+    uint32_t commands;
+    uint32_t data;
+    uint32_t slow;           // clear / return home
+    uint32_t violations;     // frames that arrived while the controller was busy
+    uint64_t bus_ns;         // wire time of all frames
+    uint64_t last_done_ns;   // when the last frame finished executing
+} hd_stats_t;
+
+void hd_attach(void); // power on and take over the SPI sink
+void hd_reset(void);
+void hd_get_stats(hd_stats_t *out);
+
+// --- Rendered state ---
+void hd_visible_row(int row, char out[17]); // the 16 columns on the glass
+char hd_ddram(int row, int col);
+int hd_shift(void);                          // DDRAM column at visible column 0
+bool hd_display_on(void);
+bool hd_cursor(int *row, int *col);          // visible cursor position, false if hidden or off-screen
+
+#endif
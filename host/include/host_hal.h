@@ -0,0 +1,47 @@
+#ifndef HOST_HAL_H
+#define HOST_HAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Host-side controls for the simulated hardware in host/hal/hal.c.
+// Time only moves when the host asks for it (or code busy-waits), so
+// runs are repeatable.
+
+// --- Simulated clock ---
+uint64_t host_now_ns(void);
+void host_advance_us(uint64_t us); // run every event due in the next us
+void host_idle(void);              // run up to the next pending event
+bool host_run_until(bool (*done)(void), uint64_t max_us);
+
+// --- SPI ---
+typedef void (*host_spi_sink_t)(uint16_t frame, uint64_t t_ns);
+void host_spi_set_sink(host_spi_sink_t sink); // NULL drops frames
+
+// --- Stdout ---
+typedef void (*host_stdout_sink_t)(char c);
+void host_stdout_set_sink(host_stdout_sink_t sink); // NULL writes to stdout
+uint32_t host_uart_baud(void); // console baud at the current clk_peri
+
+// --- Inputs ---
+void host_gpio_set_in(uint32_t mask, uint32_t value);
+// Called with the output levels after every GPIO write, so a model
+// (a key matrix, say) can answer on the inputs
+typedef void (*host_gpio_out_hook_t)(uint32_t out);
+void host_gpio_set_out_hook(host_gpio_out_hook_t hook);
+void host_adc_set(unsigned input, uint16_t value);
+void host_stdin_push(const char *data, size_t len);
+
+// --- Flash (host/hal/flash.c) ---
+// Erased (all 0xFF) RAM image unless attached to a file, which is then
+// mapped so writes persist across runs; a new or short file is padded
+// with erased bytes. Erase and program take their typical datasheet
+// time on the simulated clock.
+bool host_flash_attach(const char *path);
+uint32_t host_flash_erases(uint32_t flash_offs); // erase count of the sector
+
+// --- Allocation counter (host/hal/alloc.c, needs -Wl,--wrap=malloc etc.) ---
+uint64_t host_alloc_count(void);
+
+#endif
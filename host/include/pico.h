@@ -0,0 +1,26 @@
+#ifndef HOST_PICO_H
+#define HOST_PICO_H
+
+// Host stand-ins for the pico-sdk headers used by src/. They declare
+// just the API the portable modules need; host/hal/hal.c implements it
+// on a simulated clock (see host_hal.h for the host-side controls).
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define PICO_ON_DEVICE 0
+#define LIB_PICO_STDIO_UART 1 // stdout stands in for the console UART
+#define PICO_FLASH_SIZE_BYTES (4u * 1024 * 1024)
+
+typedef unsigned int uint;
+
+static inline void hw_set_bits(volatile uint32_t *addr, uint32_t mask) {
+    *addr |= mask;
+}
+
+static inline void hw_clear_bits(volatile uint32_t *addr, uint32_t mask) {
+    *addr &= ~mask;
+}
+
+#endif
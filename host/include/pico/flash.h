@@ -0,0 +1,13 @@
+#ifndef HOST_PICO_FLASH_H
+#define HOST_PICO_FLASH_H
+
+#include "pico.h"
+
+// Single core on the host: flash_safe_execute masks interrupts around
+// func and always succeeds
+#define PICO_OK 0
+
+int flash_safe_execute(void (*func)(void *), void *param, uint32_t enter_exit_timeout_ms);
+bool flash_safe_execute_core_init(void);
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef HOST_PICO_STDLIB_H
+#define HOST_PICO_STDLIB_H
+
+#include "pico.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "hardware/timer.h"
+
+// --- stdio (console on the host) ---
+#define PICO_ERROR_TIMEOUT (-1)
+
+bool stdio_init_all(void);
+int getchar_timeout_us(uint32_t timeout_us);
+int putchar_raw(int c);
+void stdio_flush(void);
+void stdio_set_chars_available_callback(void (*fn)(void *), void *param);
+
+// --- time ---
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+
+struct repeating_timer;
+typedef bool (*repeating_timer_callback_t)(struct repeating_timer *t);
+struct repeating_timer {
+    int64_t delay_us;
+    uint64_t next_us;
+    repeating_timer_callback_t callback;
+    void *user_data;
+    struct repeating_timer *next;
+};
+bool add_repeating_timer_ms(int32_t delay_ms, repeating_timer_callback_t callback,
+                            void *user_data, struct repeating_timer *out);
+
+// Busy-wait loops let simulated time move on
+void host_idle(void);
+static inline void tight_loop_contents(void) {
+    host_idle();
+}
+
+#endif
@@ -0,0 +1,106 @@
+#include "pico/stdlib.h"
+#include "host_hal.h"
+#include "keypad_mapped.h"
+#include <stdio.h>
+#include <string.h>
+
+// Keypad autorepeat check. Runs the real column scan and row ISR
+// against a model of the 4x4 matrix, holds each key (with or without
+// '*') well past the repeat delay and counts the repeat events it
+// produces. Keys that should not repeat (shifted jumps, history
+// recall) must produce none, and the ones that should must produce
+// some; anything else makes the run fail.
+
+#define SIM_HOLD_US 1500000u // a bit over 15 repeats at the default rate
+#define SIM_GAP_US 50000u    // settle between keys
+
+// Same pins and layout as src/keypad_mapped.c
+#define SIM_ROW0 2
+#define SIM_COL0 6
+static const char layout[17] = "DCBA#9630852*741"; // index = col * 4 + row
+
+static uint16_t pressed = 0; // bit per layout index
+
+// A pressed key connects its column to its row
+static void matrix_out(uint32_t out) {
+    uint32_t rows = 0;
+    for (int i = 0; i < 16; i++) {
+        if (((pressed >> i) & 1u) && ((out >> (SIM_COL0 + i / 4)) & 1u)) {
+            rows |= 1u << (SIM_ROW0 + i % 4);
+        }
+    }
+    host_gpio_set_in(0xFu << SIM_ROW0, rows);
+}
+
+static void set_key(char key, bool down) {
+    int i = (int)(strchr(layout, key) - layout);
+    if (down) {
+        pressed |= (uint16_t)(1u << i);
+    }
+    else {
+        pressed &= (uint16_t)~(1u << i);
+    }
+}
+
+typedef struct {
+    const char *name;
+    char key;
+    bool shift;
+    bool repeats;
+} sim_hold_t;
+
+static const sim_hold_t holds[] = {
+    { "A",            '1', false, true  },
+    { "cursor left",  '7', false, true  },
+    { "cursor home",  '7', true,  false },
+    { "undo",         'C', false, true  },
+    { "history older", 'A', true, false },
+    { "history newer", 'C', true, false },
+    { "ENTER",        '#', false, false },
+};
+
+// Hold one key and count its repeat events
+static uint32_t hold(const sim_hold_t *h) {
+    uint32_t repeats = 0;
+    uint16_t ev;
+
+    if (h->shift) {
+        set_key('*', true);
+        host_advance_us(SIM_GAP_US);
+    }
+    set_key(h->key, true);
+    host_advance_us(SIM_HOLD_US);
+    set_key(h->key, false);
+    set_key('*', false);
+    host_advance_us(SIM_GAP_US);
+
+    while (key_pop(&ev)) {
+        if ((ev & KEY_EV_REPEAT) && (char)(ev & 0xFF) == h->key) {
+            repeats++;
+        }
+    }
+    return repeats;
+}
+
+int main(void) {
+    bool ok = true;
+
+    stdio_init_all();
+    host_gpio_set_out_hook(matrix_out);
+    q_init();
+    keypad_init_pins();
+    keypad_init_timer();
+    host_advance_us(SIM_GAP_US);
+
+    for (size_t n = 0; n < sizeof(holds) / sizeof(holds[0]); n++) {
+        const sim_hold_t *h = &holds[n];
+        uint32_t repeats = hold(h);
+        bool pass = (repeats > 0) == h->repeats;
+        printf("%-14s %c%c held %lu ms: %lu repeats%s\n", h->name, h->shift ? '*' : ' ', h->key,
+               (unsigned long)(SIM_HOLD_US / 1000u), (unsigned long)repeats,
+               pass ? "" : h->repeats ? "  FAIL: want some" : "  FAIL: want none");
+        ok &= pass;
+    }
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,169 @@
+#include "pico/stdlib.h"
+#include "host_hal.h"
+#include "hd44780.h"
+#include "chardisp.h"
+#include "keypad_mapped.h"
+#include "events.h"
+#include "ui.h"
+#include "history.h"
+#include "clockgov.h"
+#include <stdio.h>
+#include <string.h>
+
+// Display traffic per UI action. Boots the UI against the HD44780
+// model, plays a scripted session (keys, backspace, ENTER, knob steps,
+// scrolling, history recall) and prints frames, commands, wire time
+// and settle time for each action. Every action also checks what the
+// glass shows; any mismatch or controller busy violation makes the run
+// fail, so this doubles as a display regression test. The clock
+// governor switches clk_peri under it, so every action also checks the
+// console UART is still at its boot baud.
+
+#define SIM_ACTION_US 200000u // simulated time allowed per action
+#define SIM_KNOB_INPUT 5      // ADC input the knob is on
+
+typedef enum { ACT_KEY, ACT_SHIFT_KEY, ACT_KNOB } act_kind_t;
+
+typedef struct {
+    const char *name;
+    act_kind_t kind;
+    const char *keys;  // raw keypad chars, or NULL
+    int knob_row;      // for ACT_KNOB
+    const char *line1; // expected glass contents, NULL = don't check
+    const char *line2;
+} sim_action_t;
+
+static const sim_action_t script[] = {
+    { "type A",        ACT_KEY,  "1",  0, "A               ", "                " },
+    { "type &B",       ACT_KEY,  "82", 0, "A&B             ", NULL },
+    { "backspace",     ACT_KEY,  "D",  0, "A&              ", NULL },
+    { "type C",        ACT_KEY,  "3",  0, "A&C             ", NULL },
+    { "cursor left",   ACT_KEY,  "7",  0, "A&C             ", NULL },
+    { "cursor end",    ACT_SHIFT_KEY, "9", 0, "A&C             ", NULL },
+    { "ENTER",         ACT_KEY,  "#",  0, "A&C             ", "r0:000 F=0      " },
+    { "knob row 5",    ACT_KNOB, NULL, 5, "A&C             ", "r5:101 F=1      " },
+    { "knob row 6",    ACT_KNOB, NULL, 6, "A&C             ", "r6:110 F=0      " },
+    { "knob row 7",    ACT_KNOB, NULL, 7, "A&C             ", "r7:111 F=1      " },
+    { "new expr",      ACT_KEY,  "6",  7, "(               ", "                " },
+    { "type 16 keys",  ACT_KEY,  "1828182818281828", 7, "(A&B&A&B&A&B&A&B", "&               " },
+    { "type 16 keys",  ACT_KEY,  "0303030303030303", 7, "&B&A&B&A&B&A&B&|", "C|C|C|C|C|C|C|C " },
+    { "scroll 1",      ACT_KEY,  "3",  7, "B&A&B&A&B&A&B&|C", "|C|C|C|C|C|C|CC " },
+    { "scroll 4",      ACT_KEY,  "0303", 7, "B&A&B&A&B&|C|C|C", "|C|C|C|C|CC|C|C " },
+    { "home",          ACT_SHIFT_KEY, "7", 7, "(A&B&A&B&A&B&A&B", "&|C|C|C|C|C|C|C|" },
+    { "end",           ACT_SHIFT_KEY, "9", 7, "B&A&B&A&B&|C|C|C", "|C|C|C|C|CC|C|C " },
+    { "clear to start", ACT_SHIFT_KEY, "D", 7, "                ", "                " },
+    { "syntax error",  ACT_KEY,  "6#", 7, "SYNTAX ERROR    ", "                " },
+    { "history older", ACT_SHIFT_KEY, "A", 7, "A&C             ", "r7:111 F=1      " },
+};
+
+static void display_done_cb(void) {
+    ev_post(EV_DISPLAY);
+}
+
+static bool tick_cb(struct repeating_timer *t) {
+    (void)t;
+    ev_post(EV_TICK);
+    return true;
+}
+
+// Run the UI event loop for a stretch of simulated time
+static void run_for(uint64_t us) {
+    uint64_t end = host_now_ns() + us * 1000u;
+    while (host_now_ns() < end) {
+        ev_dispatch(ui_handlers);
+    }
+}
+
+static void knob_to_row(int row) {
+    host_adc_set(SIM_KNOB_INPUT, (uint16_t)(row * 512 + 256));
+}
+
+static bool check_line(const char *name, int row, const char *want) {
+    char got[17];
+    hd_visible_row(row, got);
+    if (want == NULL || strncmp(got, want, 16) == 0) {
+        return true;
+    }
+    printf("FAIL %s: line %d is \"%s\", want \"%.16s\"\n", name, row + 1, got, want);
+    return false;
+}
+
+int main(void) {
+    static struct repeating_timer tick_timer;
+    bool ok = true;
+
+    stdio_init_all();
+    uint32_t baud = host_uart_baud(); // at the boot clock
+    hd_attach();
+    knob_to_row(0);
+
+    init_chardisp_pins();
+    cd_init();
+    ui_init();
+    gov_init();
+    q_init();
+    history_init();
+    add_repeating_timer_ms(10, tick_cb, NULL, &tick_timer);
+    cd_set_done_callback(display_done_cb);
+    run_for(SIM_ACTION_US);
+
+    hd_stats_t boot;
+    hd_get_stats(&boot);
+    printf("boot: %lu frames, %lu slow, ready after %.1f ms\n\n", (unsigned long)boot.frames,
+           (unsigned long)boot.slow, boot.last_done_ns / 1e6);
+
+    printf("%-16s %6s %6s %6s %9s %9s\n", "action", "frames", "cmds", "data", "bus_us", "settle_us");
+    for (size_t a = 0; a < sizeof(script) / sizeof(script[0]); a++) {
+        const sim_action_t *act = &script[a];
+        hd_stats_t before, after;
+        hd_get_stats(&before);
+        uint64_t t0 = host_now_ns();
+
+        if (act->kind == ACT_KNOB) {
+            knob_to_row(act->knob_row);
+        }
+        else {
+            for (const char *k = act->keys; *k; k++) {
+                uint16_t shift = act->kind == ACT_SHIFT_KEY ? KEY_EV_SHIFT : 0;
+                key_push((uint16_t)(KEY_EV_PRESS | shift | (uint8_t)*k));
+                key_push((uint16_t)(uint8_t)*k);
+            }
+        }
+        run_for(SIM_ACTION_US);
+
+        hd_get_stats(&after);
+        uint32_t frames = after.frames - before.frames;
+        double settle_us = frames ? (after.last_done_ns - t0) / 1e3 : 0.0;
+        printf("%-16s %6lu %6lu %6lu %9.1f %9.1f\n", act->name, (unsigned long)frames,
+               (unsigned long)(after.commands - before.commands),
+               (unsigned long)(after.data - before.data),
+               (after.bus_ns - before.bus_ns) / 1e3, settle_us);
+
+        ok &= check_line(act->name, 0, act->line1);
+        ok &= check_line(act->name, 1, act->line2);
+        if (host_uart_baud() != baud) {
+            printf("FAIL %s: console at %lu baud, want %lu\n", act->name,
+                   (unsigned long)host_uart_baud(), (unsigned long)baud);
+            ok = false;
+        }
+    }
+
+    hd_stats_t total;
+    hd_get_stats(&total);
+    printf("\ntotal: %lu frames, %.1f us on the wire, %lu busy violations\n",
+           (unsigned long)total.frames, total.bus_ns / 1e3, (unsigned long)total.violations);
+    if (total.violations) {
+        ok = false;
+    }
+
+    gov_mode_stats_t idle;
+    gov_get_stats(GOV_IDLE, &idle);
+    printf("clock: %lu switches to %lu MHz, console %lu baud\n", (unsigned long)idle.entries,
+           (unsigned long)(idle.hz / 1000000u), (unsigned long)baud);
+    if (GOV_ENABLE && idle.entries == 0) {
+        printf("FAIL clock: the governor never switched\n");
+        ok = false;
+    }
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,123 @@
+#include "pico/stdlib.h"
+#include "host_hal.h"
+#include "hd44780.h"
+#include "chardisp.h"
+#include "keypad_mapped.h"
+#include "events.h"
+#include "trace.h"
+#include "log.h"
+#include "prof.h"
+#include "ui.h"
+#include "history.h"
+#include "clockgov.h"
+#include <stdio.h>
+#include <string.h>
+
+// Plays a recorded input trace (see trace.h) through the UI on the
+// simulated hardware, the same way ":replay" does on the device, and
+// adds the HD44780 model's view of the display traffic.
+//
+//   replay [-f] TRACE     -f: as fast as the UI settles
+
+#define REPLAY_MAX_US (600u * 1000000u) // give up after 10 simulated minutes
+
+static void display_done_cb(void) {
+    ev_post(EV_DISPLAY);
+}
+
+static bool tick_cb(struct repeating_timer *t) {
+    (void)t;
+    ev_post(EV_TICK);
+    return true;
+}
+
+static void loop_once(void) {
+    ev_dispatch(ui_handlers);
+    trace_service();
+    log_drain();
+}
+
+int main(int argc, char **argv) {
+    static struct repeating_timer tick_timer;
+    bool fast = false;
+    const char *path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-f") == 0) {
+            fast = true;
+        }
+        else {
+            path = argv[i];
+        }
+    }
+    if (path == NULL) {
+        fprintf(stderr, "usage: replay [-f] TRACE\n");
+        return 2;
+    }
+    FILE *in = fopen(path, "r");
+    if (in == NULL) {
+        perror(path);
+        return 1;
+    }
+
+    stdio_init_all();
+    hd_attach();
+    prof_init();
+    init_chardisp_pins();
+    cd_init();
+    ui_init();
+    gov_init();
+    q_init();
+    history_init();
+    add_repeating_timer_ms(10, tick_cb, NULL, &tick_timer);
+    cd_set_done_callback(display_done_cb);
+    while (cd_busy()) {
+        loop_once();
+    }
+
+    hd_stats_t before;
+    hd_get_stats(&before);
+    uint64_t t0 = host_now_ns();
+
+    // Feed the trace as the serial reader would, waiting for room
+    char line[128];
+    trace_play_begin(fast);
+    while (fgets(line, sizeof(line), in) != NULL) {
+        while (!trace_play_feed(line)) {
+            loop_once();
+        }
+    }
+    fclose(in);
+    trace_play_end();
+
+    while (trace_playing() && host_now_ns() - t0 < (uint64_t)REPLAY_MAX_US * 1000u) {
+        loop_once();
+    }
+    while (log_free() < LOG_RING_LEN) {
+        log_drain();
+    }
+
+    hd_stats_t after;
+    hd_get_stats(&after);
+    printf("LCD frames=%lu commands=%lu data=%lu bus_us=%.1f violations=%lu\n",
+           (unsigned long)(after.frames - before.frames),
+           (unsigned long)(after.commands - before.commands),
+           (unsigned long)(after.data - before.data),
+           (after.bus_ns - before.bus_ns) / 1e3,
+           (unsigned long)(after.violations - before.violations));
+
+    static const char *const mode_names[GOV_MODES] = { "idle", "boost" };
+    for (int m = 0; m < GOV_MODES; m++) {
+        gov_mode_stats_t g;
+        gov_get_stats((gov_mode_t)m, &g);
+        printf("clock %-5s %3lu MHz %8.1f ms switches=%lu results=%lu\n", mode_names[m],
+               (unsigned long)(g.hz / 1000000u), g.time_us / 1e3, (unsigned long)g.entries,
+               (unsigned long)g.results);
+    }
+
+    char l1[17], l2[17];
+    hd_visible_row(0, l1);
+    hd_visible_row(1, l2);
+    printf("glass |%s|\n      |%s|\n", l1, l2);
+    return trace_playing() ? 1 : 0;
+}
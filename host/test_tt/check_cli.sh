@@ -0,0 +1,42 @@
+#!/bin/sh
+# Command line checks for test_tt: outputs for each mode, and the
+# option combinations it must refuse with exit code 2.
+#   host/test_tt/check_cli.sh .pio/build/test_tt/program
+# Exits non-zero on the first difference.
+
+TT=${1:?usage: check_cli.sh TEST_TT}
+TMP=$(mktemp -d) || exit 1
+trap 'rm -rf "$TMP"' EXIT
+fail=0
+
+# expect NAME STATUS OUTPUT -- ARGS...
+expect() {
+    name=$1 want_status=$2 want_out=$3
+    shift 4
+    out=$("$TT" "$@" 2>/dev/null < /dev/null)
+    status=$?
+    if [ "$status" -ne "$want_status" ] || [ "$out" != "$want_out" ]; then
+        echo "FAIL $name: exit $status, output \"$out\"; want exit $want_status, \"$want_out\""
+        fail=1
+    fi
+}
+
+printf 'A&B\nA|\n' > "$TMP/in.txt"
+
+expect "args"             0 "OK 80"          -- 'A&B&C'
+expect "file"             0 "OK c0
+ERR 1"                                       -- -f "$TMP/in.txt"
+expect "-m with -o"       2 ""               -- -m "$TMP/out.bin" -o text 'A'
+expect "-o with -m"       2 ""               -- -o bin -m "$TMP/out.bin" 'A'
+expect "-f with args"     2 ""               -- -f "$TMP/in.txt" 'A'
+expect "-f - with args"   2 ""               -- -f - 'A'
+expect "bad -o"           2 ""               -- -o hex 'A'
+
+"$TT" -m "$TMP/out.bin" 'A' 'A|' || fail=1
+if [ "$(od -An -tx1 "$TMP/out.bin" | tr -d ' \n')" != "00f00100" ]; then
+    echo "FAIL -m: records $(od -An -tx1 "$TMP/out.bin")"
+    fail=1
+fi
+
+[ "$fail" -eq 0 ] && echo PASS || echo FAIL
+exit "$fail"
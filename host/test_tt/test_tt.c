@@ -0,0 +1,246 @@
+#include "outputbuilder.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Host truth table tool built from the firmware's outputbuilder.c.
+//
+//   test_tt [-o text|table|bin | -m OUT] [-f FILE | EXPR...]
+//
+// Expressions come from the arguments, from FILE, or from stdin (one
+// per line, read as a stream so inputs of any size work). Output:
+//   text   "OK xx" (bit n = row n) or "ERR n" per line, as ":batch hex"
+//   table  the A B C | F listing for each expression
+//   bin    2 bytes per expression (err, packed), as ":batch bin"
+// -m writes the bin records into OUT through a memory-mapped window
+// that grows the file as it goes. -m with -o, or -f with expression
+// arguments, is a usage error (exit 2) rather than one of them winning.
+
+#define TT_LINE_MAX 63      // longest expression the firmware accepts
+#define TT_MAP_WINDOW (1u << 20)
+
+typedef enum { OUT_TEXT, OUT_TABLE, OUT_BIN } out_format_t;
+
+static void die(const char *what) {
+    fprintf(stderr, "test_tt: %s: %s\n", what, strerror(errno));
+    exit(1);
+}
+
+// ---------------------------------------------------------
+// 1. MAPPED OUTPUT
+// ---------------------------------------------------------
+static int map_fd = -1;
+static uint8_t *map_base = NULL; // window onto [map_off, map_off + TT_MAP_WINDOW)
+static off_t map_off = 0;
+static size_t map_pos = 0;       // write position within the window
+
+static void map_window(off_t off) {
+    if (map_base) {
+        munmap(map_base, TT_MAP_WINDOW);
+    }
+    if (ftruncate(map_fd, off + TT_MAP_WINDOW) != 0) {
+        die("ftruncate");
+    }
+    map_base = mmap(NULL, TT_MAP_WINDOW, PROT_READ | PROT_WRITE, MAP_SHARED, map_fd, off);
+    if (map_base == MAP_FAILED) {
+        die("mmap");
+    }
+    map_off = off;
+    map_pos = 0;
+}
+
+static void map_open(const char *path) {
+    map_fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (map_fd < 0) {
+        die(path);
+    }
+    map_window(0);
+}
+
+// Records are 2 bytes and the window is even, so none straddle it
+static void map_put(uint8_t err, uint8_t packed) {
+    if (map_pos == TT_MAP_WINDOW) {
+        map_window(map_off + TT_MAP_WINDOW);
+    }
+    map_base[map_pos++] = err;
+    map_base[map_pos++] = packed;
+}
+
+static void map_close(void) {
+    off_t size = map_off + (off_t)map_pos;
+    munmap(map_base, TT_MAP_WINDOW);
+    if (ftruncate(map_fd, size) != 0) {
+        die("ftruncate");
+    }
+    close(map_fd);
+}
+
+// ---------------------------------------------------------
+// 2. EVALUATION
+// ---------------------------------------------------------
+static out_format_t format = OUT_TEXT;
+
+static void emit(const char *expr, int err, truth_table_t table) {
+    uint8_t packed = err == ERR_OK ? table.bits : 0;
+
+    if (map_fd >= 0) {
+        map_put((uint8_t)err, packed);
+        return;
+    }
+
+    switch (format) {
+    case OUT_BIN:
+        putchar(err);
+        putchar(packed);
+        break;
+    case OUT_TABLE:
+        printf("Expression: \"%s\"\n", expr);
+        if (err != ERR_OK) {
+            printf("  Error: %d\n", err);
+            break;
+        }
+        printf("  A B C | F\n  -------+---\n");
+        for (unsigned row = 0; row < TT_ROWS; row++) {
+            printf("  %u %u %u | %d\n", (row >> 2) & 1, (row >> 1) & 1, row & 1, tt_get(table, row));
+        }
+        break;
+    default:
+        if (err == ERR_OK) {
+            char hex[TT_HEX_LEN + 1];
+            tt_to_hex(table, hex);
+            printf("OK %s\n", hex);
+        }
+        else {
+            printf("ERR %d\n", err);
+        }
+        break;
+    }
+}
+
+static void eval_one(const char *expr, size_t len) {
+    truth_table_t table = { 0 };
+    int err = len > TT_LINE_MAX ? ERR_TOKEN_OVERFLOW : build_truth_table(expr, &table);
+    emit(expr, err, table);
+}
+
+// One expression per line; blank lines are skipped. Overlong lines are
+// consumed in pieces and reported as ERR_TOKEN_OVERFLOW.
+static void eval_stream(FILE *in) {
+    char line[TT_LINE_MAX + 2];
+    size_t len = 0;
+    bool overlong = false;
+    int c;
+
+    while ((c = getc_unlocked(in)) != EOF) {
+        if (c == '\r') {
+            continue;
+        }
+        if (c != '\n') {
+            if (len < sizeof(line) - 1) {
+                line[len++] = (char)c;
+            }
+            else {
+                overlong = true;
+            }
+            continue;
+        }
+        if (len > 0 || overlong) {
+            line[len] = '\0';
+            eval_one(line, overlong ? TT_LINE_MAX + 1 : len);
+        }
+        len = 0;
+        overlong = false;
+    }
+    if (len > 0 || overlong) {
+        line[len] = '\0';
+        eval_one(line, overlong ? TT_LINE_MAX + 1 : len);
+    }
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: test_tt [-o text|table|bin | -m OUT] [-f FILE | EXPR...]\n");
+    exit(2);
+}
+
+static void conflict(const char *what) {
+    fprintf(stderr, "test_tt: %s\n", what);
+    usage();
+}
+
+int main(int argc, char **argv) {
+    const char *in_path = NULL;
+    const char *map_path = NULL;
+    bool format_set = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "o:m:f:h")) != -1) {
+        switch (opt) {
+        case 'o':
+            if (strcmp(optarg, "text") == 0) {
+                format = OUT_TEXT;
+            }
+            else if (strcmp(optarg, "table") == 0) {
+                format = OUT_TABLE;
+            }
+            else if (strcmp(optarg, "bin") == 0) {
+                format = OUT_BIN;
+            }
+            else {
+                usage();
+            }
+            format_set = true;
+            break;
+        case 'm':
+            map_path = optarg;
+            break;
+        case 'f':
+            in_path = optarg;
+            break;
+        default:
+            usage();
+        }
+    }
+    if (map_path && format_set) {
+        conflict("-m always writes bin records; drop -o");
+    }
+    if (in_path && optind < argc) {
+        conflict("give expressions either with -f or as arguments, not both");
+    }
+
+    static char out_buf[1 << 16];
+    setvbuf(stdout, out_buf, _IOFBF, sizeof(out_buf));
+
+    if (map_path) {
+        map_open(map_path);
+    }
+
+    if (optind < argc) {
+        for (int i = optind; i < argc; i++) {
+            eval_one(argv[i], strlen(argv[i]));
+        }
+    }
+    else if (in_path && strcmp(in_path, "-") != 0) {
+        FILE *in = fopen(in_path, "r");
+        if (!in) {
+            die(in_path);
+        }
+        static char in_buf[1 << 16];
+        setvbuf(in, in_buf, _IOFBF, sizeof(in_buf));
+        eval_stream(in);
+        fclose(in);
+    }
+    else {
+        eval_stream(stdin);
+    }
+
+    if (map_path) {
+        map_close();
+    }
+    fflush(stdout);
+    return 0;
+}
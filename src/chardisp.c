@@ -2,78 +2,455 @@
 #include "hardware/spi.h"
 #include "hardware/dma.h"
 #include "hardware/gpio.h"
+#include "hardware/clocks.h"
 #include "chardisp.h"
+#include "prof.h"
+#include <string.h>
 
 
 // Make sure to set these in main.c
 extern const int SPI_DISP_SCK; extern const int SPI_DISP_CSn; extern const int SPI_DISP_TX;
+extern const int SPI_DISP_DMA_CHANNEL;
 
 /***************************************************************** */
 
+// Command scheduler. Frames wait in a ring; the scheduler sends each
+// one no sooner than the controller can accept it. Runs of fast
+// commands go out by DMA paced by a DMA timer; slow commands (clear,
+// home) and explicit delays are timed with a hardware alarm.
+#define CD_SPI_BAUD    1000000u
+#define CD_EXEC_US     40u    // data write / most instructions (37 us)
+#define CD_EXEC_SLOW_US 1640u // clear display, return home (1.52 ms)
+#define CD_DMA_TIMER   0      // DMA pacing timer
+#define CD_ALARM       2      // TIMER0 alarm (0 and 1 belong to the keypad)
+
+#define CD_Q_LEN     256      // power of two
+#define CD_Q_DELAY   0x8000u  // entry is a delay of (entry & 0x7FFF) us
+#define CD_BATCH_MAX 64
+
+static uint16_t cd_q[CD_Q_LEN];
+static volatile uint32_t cd_q_head = 0; // written by producer
+static volatile uint32_t cd_q_tail = 0; // written by scheduler
+static uint16_t cd_batch[CD_BATCH_MAX]; // frames owned by DMA
+static volatile bool cd_running = false;
+static uint32_t cd_frame_us = 10; // SPI wire time of one 9-bit frame
+static void (*cd_done_cb)(void) = NULL;
+
+static bool cd_is_slow(uint16_t frame) {
+    // 0x01 clear display, 0x02/0x03 return home
+    return frame == 0x001 || frame == 0x002 || frame == 0x003;
+}
+
+static void cd_alarm_in(uint32_t us) {
+    timer_hw->alarm[CD_ALARM] = timer_hw->timerawl + us;
+}
+
+static void cd_kick(void);
+void send_spi_cmd(spi_inst_t* spi, uint16_t value);
+
+static void cd_alarm_isr(void) {
+    timer_hw->intr = (1u << CD_ALARM);
+    cd_kick();
+}
+
+static void cd_dma_isr(void) {
+    dma_channel_acknowledge_irq0(SPI_DISP_DMA_CHANNEL);
+    // The last frame was just written to the FIFO; give it wire and
+    // execution time before the next command
+    cd_alarm_in(cd_frame_us + CD_EXEC_US);
+}
+
+// Dispatch the next entry or run of entries. Called with the scheduler
+// idle: from the alarm/DMA ISRs or with interrupts disabled.
+static void cd_kick(void) {
+    uint32_t tail = cd_q_tail;
+    if (tail == cd_q_head) {
+        cd_running = false;
+        if (cd_done_cb) {
+            cd_done_cb();
+        }
+        return;
+    }
+    cd_running = true;
+
+    uint16_t e = cd_q[tail % CD_Q_LEN];
+
+    if (e & CD_Q_DELAY) {
+        cd_q_tail = tail + 1;
+        cd_alarm_in(e & 0x7FFFu);
+        return;
+    }
+
+    if (cd_is_slow(e)) {
+        cd_q_tail = tail + 1;
+        send_spi_cmd(spi0, e);
+        cd_alarm_in(cd_frame_us + CD_EXEC_SLOW_US);
+        return;
+    }
+
+    int n = 0;
+    while (tail != cd_q_head && n < CD_BATCH_MAX) {
+        e = cd_q[tail % CD_Q_LEN];
+        if ((e & CD_Q_DELAY) || cd_is_slow(e)) {
+            break;
+        }
+        cd_batch[n++] = e;
+        tail++;
+    }
+    cd_q_tail = tail;
+    dma_channel_transfer_from_buffer_now(SPI_DISP_DMA_CHANNEL, cd_batch, (uint)n);
+}
+
+// Pace DMA so consecutive frames start one wire time plus one
+// execution time apart
+static void cd_retune_pacing(void) {
+    uint32_t period_us = cd_frame_us + CD_EXEC_US;
+    uint32_t den = (uint32_t)((uint64_t)clock_get_hz(clk_sys) * period_us / 1000000u);
+    if (den > 0xFFFFu) {
+        den = 0xFFFFu;
+    }
+    dma_timer_set_fraction(CD_DMA_TIMER, 1, (uint16_t)den);
+}
+
+static void cd_set_frame_time(uint actual_baud) {
+    cd_frame_us = (9u * 1000000u + actual_baud - 1) / actual_baud;
+}
+
+static void cd_sched_init(uint actual_baud) {
+    cd_set_frame_time(actual_baud);
+
+    dma_timer_claim(CD_DMA_TIMER);
+    cd_retune_pacing();
+
+    dma_channel_config c = dma_channel_get_default_config(SPI_DISP_DMA_CHANNEL);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, dma_get_timer_dreq(CD_DMA_TIMER));
+    dma_channel_configure(SPI_DISP_DMA_CHANNEL, &c, &spi_get_hw(spi0)->dr, cd_batch, 0, false);
+
+    dma_channel_set_irq0_enabled(SPI_DISP_DMA_CHANNEL, true);
+    irq_set_exclusive_handler(DMA_IRQ_0, cd_dma_isr);
+    irq_set_enabled(DMA_IRQ_0, true);
+
+    irq_set_exclusive_handler(TIMER0_IRQ_2, cd_alarm_isr);
+    irq_set_enabled(TIMER0_IRQ_2, true);
+    hw_set_bits(&timer_hw->inte, (1u << CD_ALARM));
+}
+
+// Shadow of what has been sent to the glass, for dirty-cell diffing.
+// It covers the whole 40-column DDRAM row so that content scrolled out
+// of view by a display shift is still known when it scrolls back.
+#define CD_ROWS 2
+#define CD_COLS 16
+
+static char cd_shadow[CD_ROWS][CD_DDRAM_COLS];
+static cd_stats_t cd_stats;
+
+static int cd_shift_glass = 0; // DDRAM column shown at visible column 0
+static int cd_shift_want = 0;
+static int cd_ac = 0;          // expected address counter, -1 if unknown
+static bool cd_cursor_glass = false;
+static bool cd_cursor_want = false;
+static int cd_cursor_row = 0;
+static int cd_cursor_col = 0;
+
+// Compositor back buffer. UI code draws here; cd_service flushes it at
+// most once per frame interval.
+static char cd_back[CD_ROWS][CD_COLS + 1];
+static bool cd_back_dirty = false;
+static uint32_t cd_frame_interval_us = 20000u;
+static uint32_t cd_last_flush_us = 0;
+
+static const uint8_t cd_row_addr[CD_ROWS] = { 0x00, 0x40 };
+
 // "chardisp" stands for character display, which can be an LCD or OLED
 void init_chardisp_pins() {
     gpio_set_function(SPI_DISP_SCK, GPIO_FUNC_SPI);
     gpio_set_function(SPI_DISP_TX,  GPIO_FUNC_SPI);
     gpio_set_function(SPI_DISP_CSn, GPIO_FUNC_SPI);
 
-    spi_init(spi0, 10000);
+    // The scheduler enforces command timing, so the bus can run fast
+    uint baud = spi_init(spi0, CD_SPI_BAUD);
     spi_set_format(spi0, 9, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
-    // fill in
+    cd_sched_init(baud);
 }
 
+// clk_sys (and clk_peri with it) changed: the SPI divider and the DMA
+// timer fraction are both derived from it
+void cd_retune_clock(void) {
+    cd_set_frame_time(spi_set_baudrate(spi0, CD_SPI_BAUD));
+    cd_retune_pacing();
+}
+
+// Write one frame straight to the TX FIFO. Only the scheduler calls
+// this, when nothing else is in flight.
 void send_spi_cmd(spi_inst_t* spi, uint16_t value) {
     uint16_t mask = 0x01FFu; //9 bits
     value &= mask;
 
         while (!spi_is_writable(spi)){
 
-        }
-        while(spi_is_busy(spi)){
-
         }
 
         spi_get_hw(spi)->dr = value;
-
-    // fill in
 }
 
 void send_spi_data(spi_inst_t* spi, uint16_t value) {
     uint16_t data = 0x0100u;
     send_spi_cmd(spi, (value & 0xFFu) | data);
-    // fill in
 }
 
+// Queue the init sequence; the scheduler times it, so this returns
+// immediately and the glass is ready once cd_busy() goes false.
 void cd_init() {
-    sleep_ms(1);
+    static const uint16_t init_seq[] = {
+        CD_Q_DELAY | 20000u, // power-on: 40 ms from Vcc before the
+        CD_Q_DELAY | 20000u, // first command (no boot delay covers it)
+        0b00111100,         // function set
+        0b00001100,         // display on, cursor off
+        0b00000001,         // clear (slow)
+        0b00000110,         // entry mode: increment
+    };
 
-    send_spi_cmd(spi0, 0b00111100);
-    sleep_us(40);
+    // Clear blanks DDRAM and undoes any display shift
+    memset(cd_shadow, ' ', sizeof(cd_shadow));
+    cd_shift_glass = cd_shift_want = 0;
+    cd_cursor_glass = cd_cursor_want = false;
+    cd_ac = 0;
+    for (int r = 0; r < CD_ROWS; ++r) {
+        memset(cd_back[r], ' ', CD_COLS);
+        cd_back[r][CD_COLS] = '\0';
+    }
 
+    cd_submit(init_seq, (int)(sizeof(init_seq) / sizeof(init_seq[0])));
+}
 
-    send_spi_cmd(spi0, 0b00001100);
-    sleep_us(40);
+bool cd_busy(void) {
+    return cd_running || cd_q_tail != cd_q_head;
+}
 
-    send_spi_cmd(spi0, 0b00000001);
-    sleep_ms(2);
+void cd_wait_idle(void) {
+    while (cd_busy()) {
+        tight_loop_contents();
+    }
+}
 
-    send_spi_cmd(spi0, 0b00000110);
-    sleep_us(40);
-    // fill in
+void cd_set_done_callback(void (*cb)(void)) {
+    cd_done_cb = cb;
 }
 
-void cd_display1(const char *str) {
-    send_spi_cmd(spi0, 0x80 | 0x00);
+// Queue frames behind whatever is in flight. Only blocks when the
+// ring is full.
+void cd_submit(const uint16_t *frames, int count) {
+    for (int i = 0; i < count; ++i) {
+        while (cd_q_head - cd_q_tail >= CD_Q_LEN) {
+            tight_loop_contents();
+        }
+        uint16_t e = frames[i];
+        cd_q[cd_q_head % CD_Q_LEN] = (e & CD_Q_DELAY) ? e : (e & 0x01FFu);
+        cd_q_head = cd_q_head + 1;
+    }
 
-    for (int i = 0; i < 16 && str[i] != '\0'; ++i) {
-        send_spi_data(spi0, (uint8_t)str[i]);
+    uint32_t irq = save_and_disable_interrupts();
+    if (!cd_running) {
+        cd_kick();
     }
+    restore_interrupts(irq);
+}
+
+static int cd_build_line(uint16_t *out, int row, const char *str) {
+    int n = 0;
+    out[n++] = 0x80 | cd_row_addr[row];
+    for (int i = 0; i < CD_COLS && str[i] != '\0'; ++i) {
+        out[n++] = 0x100 | (uint8_t)str[i];
+        cd_shadow[row][i] = str[i];
+    }
+    cd_ac = -1;
+    return n;
+}
+
+void cd_display1(const char *str) {
+    uint16_t frames[17];
+    cd_submit(frames, cd_build_line(frames, 0, str));
 }
 
 void cd_display2(const char *str) {
-    send_spi_cmd(spi0, 0x80 | 0x40);
+    uint16_t frames[17];
+    cd_submit(frames, cd_build_line(frames, 1, str));
+}
+
+// Bring the display shift to the wanted offset. One shift command
+// moves the view by one column; returning to zero from further away
+// is a single (slow) return-home command.
+static int cd_emit_shift(uint16_t *out) {
+    int delta = (cd_shift_want - cd_shift_glass + CD_DDRAM_COLS) % CD_DDRAM_COLS;
+    int n = 0;
+
+    if (delta == 0) {
+        return 0;
+    }
+
+    if (cd_shift_want == 0 && delta != 1 && delta != CD_DDRAM_COLS - 1) {
+        out[n++] = 0x02; // return home
+        cd_ac = 0;
+    }
+    else if (delta <= CD_DDRAM_COLS / 2) {
+        while (delta--) {
+            out[n++] = 0x18; // shift display left: view moves right
+        }
+    }
+    else {
+        for (delta = CD_DDRAM_COLS - delta; delta > 0; --delta) {
+            out[n++] = 0x1C; // shift display right: view moves left
+        }
+    }
+
+    cd_shift_glass = cd_shift_want;
+    return n;
+}
+
+static int cd_view_col(int i) {
+    return (cd_shift_glass + i) % CD_DDRAM_COLS;
+}
+
+// Diff one visible row against the shadow and emit an address command
+// plus the changed bytes for each dirty run. A single clean cell
+// between two dirty ones costs the same as a new address command, so
+// runs merge across gaps of one. Runs break where the view wraps from
+// DDRAM column 39 back to 0, since the address counter does not.
+static int cd_diff_row(uint16_t *out, int row, const char *str) {
+    char want[CD_COLS];
+    int len = 0;
+    while (len < CD_COLS && str[len] != '\0') {
+        want[len] = str[len];
+        len++;
+    }
+    // Short strings are padded with blanks like a cleared line
+    for (int i = len; i < CD_COLS; ++i) {
+        want[i] = ' ';
+    }
+
+    int n = 0;
+    int i = 0;
+    while (i < CD_COLS) {
+        if (want[i] == cd_shadow[row][cd_view_col(i)]) {
+            i++;
+            continue;
+        }
+
+        int end = i + 1;
+        while (end < CD_COLS && cd_view_col(end) != 0) {
+            if (want[end] != cd_shadow[row][cd_view_col(end)]) {
+                end++;
+            }
+            else if (end + 1 < CD_COLS && cd_view_col(end + 1) != 0
+                     && want[end + 1] != cd_shadow[row][cd_view_col(end + 1)]) {
+                end += 2;
+            }
+            else {
+                break;
+            }
+        }
+
+        int addr = cd_row_addr[row] + cd_view_col(i);
+        if (cd_ac != addr) {
+            out[n++] = 0x80 | addr;
+        }
+        for (; i < end; ++i) {
+            out[n++] = 0x100 | (uint8_t)want[i];
+            cd_shadow[row][cd_view_col(i)] = want[i];
+        }
+        cd_ac = (cd_view_col(end - 1) == CD_DDRAM_COLS - 1) ? -1 : cd_row_addr[row] + cd_view_col(end);
+    }
+    return n;
+}
+
+// Park the address counter under the cursor and switch the cursor
+// glyph on or off
+static int cd_emit_cursor(uint16_t *out) {
+    int n = 0;
+
+    if (cd_cursor_want) {
+        int addr = cd_row_addr[cd_cursor_row] + cd_view_col(cd_cursor_col);
+        if (cd_ac != addr) {
+            out[n++] = 0x80 | addr;
+            cd_ac = addr;
+        }
+    }
+    if (cd_cursor_want != cd_cursor_glass) {
+        out[n++] = cd_cursor_want ? 0x0E : 0x0C;
+        cd_cursor_glass = cd_cursor_want;
+    }
+    return n;
+}
+
+int cd_update(const char *line1, const char *line2) {
+    uint16_t frames[CD_DDRAM_COLS / 2 + 2 * CD_COLS + 8];
+    int n = cd_emit_shift(frames);
+    n += cd_diff_row(frames + n, 0, line1);
+    n += cd_diff_row(frames + n, 1, line2);
+    n += cd_emit_cursor(frames + n);
+
+    if (n > 0) {
+        cd_submit(frames, n);
+    }
+
+    cd_stats.updates++;
+    cd_stats.frames_last = (uint32_t)n;
+    cd_stats.frames_total += (uint32_t)n;
+    return n;
+}
+
+void cd_set_view_shift(int shift) {
+    cd_shift_want = ((shift % CD_DDRAM_COLS) + CD_DDRAM_COLS) % CD_DDRAM_COLS;
+}
+
+void cd_set_cursor(int row, int col, bool visible) {
+    cd_cursor_row = row;
+    cd_cursor_col = col;
+    cd_cursor_want = visible;
+}
+
+void cd_get_stats(cd_stats_t *out) {
+    *out = cd_stats;
+}
+
+char *cd_back_row(int row) {
+    return cd_back[row];
+}
+
+void cd_invalidate(void) {
+    if (cd_back_dirty) {
+        cd_stats.coalesced++; // merged into the flush already owed
+    }
+    cd_back_dirty = true;
+    cd_stats.requests++;
+}
+
+bool cd_frame_pending(void) {
+    return cd_back_dirty;
+}
+
+void cd_set_frame_interval_us(uint32_t us) {
+    cd_frame_interval_us = us;
+}
+
+void cd_commit(void) {
+    if (!cd_back_dirty) {
+        return;
+    }
+    cd_back_dirty = false;
+    cd_last_flush_us = time_us_32();
+
+    PROF_BEGIN(PROF_LCD_SYNC);
+    cd_update(cd_back[0], cd_back[1]);
+    PROF_END(PROF_LCD_SYNC);
+}
 
-    for (int i = 0; i < 16 && str[i] != '\0'; ++i) {
-        send_spi_data(spi0, (uint8_t)str[i]);
+void cd_service(void) {
+    if (cd_back_dirty && time_us_32() - cd_last_flush_us >= cd_frame_interval_us) {
+        cd_commit();
     }
 }
 
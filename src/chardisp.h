@@ -1,4 +1,42 @@
+#include <stdint.h>
+#include <stdbool.h>
+
 void init_chardisp_pins(void);
 void cd_init(void);
 void cd_display1(const char *str);
 void cd_display2(const char *str);
+
+// Non-blocking DMA transfer path
+void cd_submit(const uint16_t *frames, int count);
+bool cd_busy(void);
+void cd_wait_idle(void);
+void cd_set_done_callback(void (*cb)(void));
+void cd_retune_clock(void); // after a clk_sys change, with !cd_busy()
+
+// Shadow framebuffer: only cells that differ from the glass are sent
+typedef struct {
+    uint32_t updates;      // cd_update calls
+    uint32_t frames_last;  // SPI frames sent by the last update
+    uint32_t frames_total; // SPI frames sent by all updates
+    uint32_t requests;     // cd_invalidate calls from UI code
+    uint32_t coalesced;    // requests merged into a later flush
+} cd_stats_t;
+
+int cd_update(const char *line1, const char *line2); // returns frames sent
+
+// Hardware scrolling. Each DDRAM row is 40 columns wide; the visible
+// 16 columns start at the display shift. Lines passed to cd_update are
+// the visible window, and the cursor is in visible coordinates.
+#define CD_DDRAM_COLS 40
+void cd_set_view_shift(int shift);
+void cd_set_cursor(int row, int col, bool visible);
+void cd_get_stats(cd_stats_t *out);
+
+// Frame-coalescing compositor. Draw into the back buffer rows, call
+// cd_invalidate, and let cd_service flush at the frame rate.
+char *cd_back_row(int row); // 16 chars + NUL, writable
+void cd_invalidate(void);
+void cd_service(void);      // flush if dirty and the frame interval elapsed
+void cd_commit(void);       // flush now if dirty
+bool cd_frame_pending(void); // back buffer has changes not yet flushed
+void cd_set_frame_interval_us(uint32_t us);
@@ -0,0 +1,148 @@
+#include "clockgov.h"
+#include "chardisp.h"
+#include "worker.h"
+#include "log.h"
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#if LIB_PICO_STDIO_UART
+#include "hardware/uart.h"
+#endif
+
+static gov_mode_stats_t stats[GOV_MODES];
+static gov_mode_t mode = GOV_BOOST;
+static bool boost_wanted = false;
+static uint32_t pll_hz = 0;         // pll_sys output, the boot clk_sys
+static uint64_t mode_since_us = 0;
+static uint32_t last_work_us = 0;
+static uint32_t enter_us = 0;
+static bool enter_pending = false;
+
+// ---------------------------------------------------------
+// 1. SWITCHING
+// ---------------------------------------------------------
+static void gov_account(void) {
+    uint64_t now = time_us_64();
+    stats[mode].time_us += now - mode_since_us;
+    mode_since_us = now;
+}
+
+// Only called with the display scheduler idle: nothing is on the SPI
+// wire or waiting on DMA pacing while the dividers change
+static void gov_switch(gov_mode_t m) {
+    uint32_t hz = stats[m].hz;
+    uint32_t t0 = time_us_32();
+
+#if LIB_PICO_STDIO_UART
+    uart_tx_wait_blocking(uart_default); // no byte half sent at the old baud
+#endif
+    clock_configure(clk_sys, CLOCKS_CLK_SYS_CTRL_SRC_VALUE_CLKSRC_CLK_SYS_AUX,
+                    CLOCKS_CLK_SYS_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS, pll_hz, hz);
+    // clk_peri is clk_sys undivided; tell the SDK so the SPI and UART
+    // dividers are computed from the new rate
+    clock_configure(clk_peri, 0, CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLK_SYS, hz, hz);
+    cd_retune_clock();
+#if LIB_PICO_STDIO_UART
+    uart_set_baudrate(uart_default, PICO_DEFAULT_UART_BAUD_RATE);
+#endif
+
+    gov_account();
+    mode = m;
+    stats[m].entries++;
+    uint32_t us = time_us_32() - t0;
+    if (us > stats[m].switch_us_max) {
+        stats[m].switch_us_max = us;
+    }
+}
+
+// ---------------------------------------------------------
+// 2. PUBLIC API
+// ---------------------------------------------------------
+void gov_init(void) {
+    pll_hz = clock_get_hz(clk_sys);
+    for (int m = 0; m < GOV_MODES; m++) {
+        stats[m] = (gov_mode_stats_t){ 0 };
+    }
+    stats[GOV_BOOST].hz = pll_hz;
+    stats[GOV_IDLE].hz = pll_hz / GOV_IDLE_DIV;
+    mode = GOV_BOOST;
+    boost_wanted = false;
+    enter_pending = false;
+    mode_since_us = time_us_64();
+    last_work_us = time_us_32();
+}
+
+void gov_boost(void) {
+    last_work_us = time_us_32();
+    boost_wanted = GOV_ENABLE && mode != GOV_BOOST;
+    gov_service();
+}
+
+void gov_enter(void) {
+    enter_us = time_us_32();
+    enter_pending = true;
+    gov_boost();
+}
+
+void gov_result_shown(void) {
+    if (!enter_pending) {
+        return;
+    }
+    enter_pending = false;
+
+    uint32_t us = time_us_32() - enter_us;
+    gov_mode_stats_t *s = &stats[mode];
+    s->results++;
+    s->latency_us_sum += us;
+    if (us > s->latency_us_max) {
+        s->latency_us_max = us;
+    }
+}
+
+void gov_service(void) {
+    if (!GOV_ENABLE || cd_busy()) {
+        return; // a switch waits for the display to go idle (EV_DISPLAY)
+    }
+    if (boost_wanted) {
+        boost_wanted = false;
+        gov_switch(GOV_BOOST);
+    }
+    else if (mode == GOV_BOOST && !worker_busy() && time_us_32() - last_work_us >= GOV_LINGER_US) {
+        gov_switch(GOV_IDLE);
+    }
+}
+
+gov_mode_t gov_mode(void) {
+    return mode;
+}
+
+void gov_get_stats(gov_mode_t m, gov_mode_stats_t *out) {
+    gov_account();
+    *out = stats[m];
+}
+
+void gov_report(void) {
+    static const char *const names[GOV_MODES] = { "idle", "boost" };
+    uint64_t total_us = 0, weighted = 0;
+
+    gov_account();
+    for (int m = 0; m < GOV_MODES; m++) {
+        const gov_mode_stats_t *s = &stats[m];
+        total_us += s->time_us;
+        weighted += s->time_us * (s->hz / 1000u);
+    }
+    for (int m = 0; m < GOV_MODES; m++) {
+        const gov_mode_stats_t *s = &stats[m];
+        log_printf("GOV %-5s %3lu MHz %9lu ms %3lu%% switches=%lu max=%luus enter n=%lu avg=%luus max=%luus\n",
+                   names[m], (unsigned long)(s->hz / 1000000u), (unsigned long)(s->time_us / 1000u),
+                   (unsigned long)(total_us ? s->time_us * 100u / total_us : 0),
+                   (unsigned long)s->entries, (unsigned long)s->switch_us_max,
+                   (unsigned long)s->results,
+                   (unsigned long)(s->results ? s->latency_us_sum / s->results : 0),
+                   (unsigned long)s->latency_us_max);
+    }
+    // Dynamic power goes with the clock at a fixed core voltage
+    uint64_t full = total_us * (stats[GOV_BOOST].hz / 1000u);
+    log_printf("GOV est. dynamic power %lu%% of a fixed %lu MHz clock\n",
+               (unsigned long)(full ? weighted * 100u / full : 100u),
+               (unsigned long)(stats[GOV_BOOST].hz / 1000000u));
+}
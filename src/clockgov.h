@@ -0,0 +1,55 @@
+#ifndef CLOCKGOV_H
+#define CLOCKGOV_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// clk_sys governor. Between keypresses the system clock runs divided
+// down from pll_sys; ENTER (or a serial batch line) boosts it back to
+// the boot clock for the parse, evaluation and result render, and it
+// drops again once the worker and the display have been idle for
+// GOV_LINGER_US. Only the clk_sys divider changes, so pll_sys stays
+// locked and the core voltage stays at its default.
+//
+// clk_peri follows clk_sys, so each switch re-derives the LCD SPI
+// divider and DMA pacing (cd_retune_clock) and the console UART baud
+// divisor. Switches wait for the display scheduler to be idle and the
+// UART to drain. The keypad alarms and the tick run on the 1 MHz
+// timer and the knob ADC on the 48 MHz clk_adc, so they are
+// unaffected. Build with GOV_ENABLE=0 to hold the boot clock while
+// still collecting the statistics, for comparison.
+
+#ifndef GOV_ENABLE
+#define GOV_ENABLE 1
+#endif
+#ifndef GOV_IDLE_DIV
+#define GOV_IDLE_DIV 3 // 150 MHz -> 50 MHz between keypresses
+#endif
+#define GOV_LINGER_US 100000u // stay boosted this long after the last work
+
+typedef enum {
+    GOV_IDLE = 0,
+    GOV_BOOST,
+    GOV_MODES
+} gov_mode_t;
+
+typedef struct {
+    uint32_t hz;             // clk_sys in this mode
+    uint64_t time_us;        // time spent in it
+    uint32_t entries;        // switches into it
+    uint32_t switch_us_max;  // longest switch into it, retune included
+    uint32_t results;        // ENTER results shown while in it
+    uint64_t latency_us_sum; // ENTER to result on the glass
+    uint32_t latency_us_max;
+} gov_mode_stats_t;
+
+void gov_init(void);          // after init_chardisp_pins; starts boosted
+void gov_boost(void);         // evaluation work coming: boost (when the display allows)
+void gov_enter(void);         // keypad ENTER: gov_boost and start the latency clock
+void gov_result_shown(void);  // ENTER result drawn: stop the latency clock
+void gov_service(void);       // UI tick and display idle: apply pending switches
+gov_mode_t gov_mode(void);
+void gov_get_stats(gov_mode_t m, gov_mode_stats_t *out);
+void gov_report(void);        // per-mode time, estimated power and latency to the log
+
+#endif
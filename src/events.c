@@ -0,0 +1,36 @@
+#include "events.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+static volatile uint32_t ev_pending = 0;
+
+void ev_post(event_id_t ev) {
+    uint32_t irq = save_and_disable_interrupts();
+    ev_pending |= (1u << ev);
+    restore_interrupts(irq);
+}
+
+uint32_t ev_take(void) {
+    uint32_t irq = save_and_disable_interrupts();
+    uint32_t pending = ev_pending;
+    ev_pending = 0;
+    restore_interrupts(irq);
+    return pending;
+}
+
+void ev_dispatch(const ev_handler_t handlers[EV_COUNT]) {
+    // Check and sleep with interrupts masked: an IRQ that arrives after
+    // the check still wakes WFI, and its handler runs once unmasked.
+    uint32_t irq = save_and_disable_interrupts();
+    if (ev_pending == 0) {
+        __wfi();
+    }
+    restore_interrupts(irq);
+
+    uint32_t pending = ev_take();
+    for (int ev = 0; ev < EV_COUNT; ev++) {
+        if ((pending & (1u << ev)) && handlers[ev]) {
+            handlers[ev]();
+        }
+    }
+}
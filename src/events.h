@@ -0,0 +1,30 @@
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Event flags posted by interrupt handlers and callbacks. The main loop
+// sleeps until one is pending and then runs the matching handler.
+typedef enum {
+    EV_KEY = 0,   // keypad queue has events
+    EV_TICK,      // periodic tick (knob sampling, compositor frames)
+    EV_SERIAL,    // stdio has input
+    EV_DISPLAY,   // display command queue drained
+    EV_RESULT,    // the worker finished a job
+    EV_COUNT
+} event_id_t;
+
+typedef void (*ev_handler_t)(void);
+
+// Safe to call from any IRQ handler
+void ev_post(event_id_t ev);
+
+// Atomically fetch and clear the pending mask (bit n = event n)
+uint32_t ev_take(void);
+
+// Sleep in WFI until at least one event is pending, then run the
+// handler of every pending event in table order
+void ev_dispatch(const ev_handler_t handlers[EV_COUNT]);
+
+#endif
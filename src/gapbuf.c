@@ -0,0 +1,177 @@
+#include "gapbuf.h"
+
+#define GB_OP_INSERT 1
+#define GB_OP_DELETE 2
+#define GB_UNDO_MASK (GB_UNDO_MAX - 1)
+
+// ---------------------------------------------------------
+// 1. QUERIES
+// ---------------------------------------------------------
+void gb_init(gapbuf_t *gb) {
+    gb->gap_start = 0;
+    gb->gap_end = GB_CAPACITY;
+    gb->undo_head = 0;
+    gb->undo_count = 0;
+    gb->group = 0;
+    gb->group_open = false;
+}
+
+int gb_len(const gapbuf_t *gb) {
+    return GB_CAPACITY - (gb->gap_end - gb->gap_start);
+}
+
+int gb_cursor(const gapbuf_t *gb) {
+    return gb->gap_start;
+}
+
+char gb_at(const gapbuf_t *gb, int i) {
+    if (i < gb->gap_start) {
+        return gb->buf[i];
+    }
+    return gb->buf[i + (gb->gap_end - gb->gap_start)];
+}
+
+int gb_copy(const gapbuf_t *gb, char *out, int out_size) {
+    int len = gb_len(gb);
+    if (len > out_size - 1) {
+        len = out_size - 1;
+    }
+    for (int i = 0; i < len; i++) {
+        out[i] = gb_at(gb, i);
+    }
+    out[len] = '\0';
+    return len;
+}
+
+// ---------------------------------------------------------
+// 2. UNDO LOG
+// ---------------------------------------------------------
+static gb_undo_t *gb_newest(gapbuf_t *gb) {
+    return &gb->undo[(gb->undo_head + gb->undo_count - 1) & GB_UNDO_MASK];
+}
+
+// Full: forget the oldest group whole, so undo never stops halfway
+// through one. A group that fills the whole log loses records one at
+// a time instead.
+static void gb_drop_oldest(gapbuf_t *gb) {
+    uint8_t group = gb->undo[gb->undo_head].group;
+    bool whole = group != gb->group;
+    do {
+        gb->undo_head = (gb->undo_head + 1) & GB_UNDO_MASK;
+        gb->undo_count--;
+    } while (whole && gb->undo_count > 0 && gb->undo[gb->undo_head].group == group);
+}
+
+static void gb_log(gapbuf_t *gb, uint8_t type, int pos, char c) {
+    // The number only moves when a group gets its first record, so
+    // neighbouring groups always differ (cursor moves record nothing)
+    if (gb->group_open) {
+        gb->group++;
+        gb->group_open = false;
+    }
+    if (gb->undo_count == GB_UNDO_MAX) {
+        gb_drop_oldest(gb);
+    }
+    gb->undo_count++;
+    gb_undo_t *u = gb_newest(gb);
+    u->type = type;
+    u->pos = (uint8_t)pos;
+    u->c = c;
+    u->group = gb->group;
+}
+
+void gb_begin_group(gapbuf_t *gb) {
+    gb->group_open = true;
+}
+
+// ---------------------------------------------------------
+// 3. EDITING
+// ---------------------------------------------------------
+static bool gb_insert_raw(gapbuf_t *gb, char c) {
+    if (gb->gap_start == gb->gap_end) {
+        return false; // full
+    }
+    gb->buf[gb->gap_start++] = c;
+    return true;
+}
+
+bool gb_insert(gapbuf_t *gb, char c) {
+    if (!gb_insert_raw(gb, c)) {
+        return false;
+    }
+    gb_log(gb, GB_OP_INSERT, gb->gap_start - 1, c);
+    return true;
+}
+
+bool gb_backspace(gapbuf_t *gb) {
+    if (gb->gap_start == 0) {
+        return false;
+    }
+    gb->gap_start--;
+    gb_log(gb, GB_OP_DELETE, gb->gap_start, gb->buf[gb->gap_start]);
+    return true;
+}
+
+bool gb_delete(gapbuf_t *gb) {
+    if (gb->gap_end == GB_CAPACITY) {
+        return false;
+    }
+    gb_log(gb, GB_OP_DELETE, gb->gap_start, gb->buf[gb->gap_end]);
+    gb->gap_end++;
+    return true;
+}
+
+int gb_clear_to_start(gapbuf_t *gb) {
+    int n = 0;
+    while (gb_backspace(gb)) {
+        n++;
+    }
+    return n;
+}
+
+bool gb_undo(gapbuf_t *gb) {
+    if (gb->undo_count == 0) {
+        return false;
+    }
+    uint8_t group = gb_newest(gb)->group;
+
+    while (gb->undo_count > 0 && gb_newest(gb)->group == group) {
+        gb_undo_t *u = gb_newest(gb);
+        gb->undo_count--;
+        if (u->type == GB_OP_INSERT) {
+            gb_move_to(gb, u->pos + 1);
+            gb->gap_start--;
+        }
+        else {
+            gb_move_to(gb, u->pos);
+            gb_insert_raw(gb, u->c);
+        }
+    }
+    return true;
+}
+
+// ---------------------------------------------------------
+// 4. CURSOR MOVEMENT
+// ---------------------------------------------------------
+bool gb_left(gapbuf_t *gb) {
+    if (gb->gap_start == 0) {
+        return false;
+    }
+    gb->buf[--gb->gap_end] = gb->buf[--gb->gap_start];
+    return true;
+}
+
+bool gb_right(gapbuf_t *gb) {
+    if (gb->gap_end == GB_CAPACITY) {
+        return false;
+    }
+    gb->buf[gb->gap_start++] = gb->buf[gb->gap_end++];
+    return true;
+}
+
+void gb_move_to(gapbuf_t *gb, int pos) {
+    while (gb->gap_start > pos && gb_left(gb)) {
+    }
+    while (gb->gap_start < pos && gb_right(gb)) {
+    }
+}
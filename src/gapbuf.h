@@ -0,0 +1,60 @@
+#ifndef GAPBUF_H
+#define GAPBUF_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Gap-buffer line editor for the expression being typed. Text before
+// the cursor sits at the front of buf, text after it at the back, so
+// insert and delete at the cursor are O(1) and moving the cursor costs
+// one char copy per column.
+
+#ifndef GB_CAPACITY
+#define GB_CAPACITY 63 // max expression length
+#endif
+#define GB_UNDO_MAX 128 // power of two: the undo log is a ring
+
+typedef struct {
+    uint8_t type;  // GB_OP_*
+    uint8_t pos;   // text index of the char
+    char c;
+    uint8_t group; // records with the same group undo together
+} gb_undo_t;
+
+typedef struct {
+    char buf[GB_CAPACITY];
+    int gap_start; // == cursor
+    int gap_end;   // first char after the gap
+
+    gb_undo_t undo[GB_UNDO_MAX];
+    int undo_head;  // ring index of the oldest record
+    int undo_count; // records in use (the oldest group goes when full)
+    uint8_t group;  // current edit group
+    bool group_open; // gb_begin_group called, no record in the group yet
+} gapbuf_t;
+
+// --- Setup ---
+void gb_init(gapbuf_t *gb);
+
+// --- Queries ---
+int gb_len(const gapbuf_t *gb);
+int gb_cursor(const gapbuf_t *gb);
+char gb_at(const gapbuf_t *gb, int i);
+// Copy the text out NUL-terminated; returns the length
+int gb_copy(const gapbuf_t *gb, char *out, int out_size);
+
+// --- Editing (at the cursor) ---
+// Start a new undo group; every edit until the next call undoes as one
+void gb_begin_group(gapbuf_t *gb);
+bool gb_insert(gapbuf_t *gb, char c);
+bool gb_backspace(gapbuf_t *gb);     // delete char before the cursor
+bool gb_delete(gapbuf_t *gb);        // delete char under the cursor
+int gb_clear_to_start(gapbuf_t *gb); // returns chars deleted
+bool gb_undo(gapbuf_t *gb);          // revert the last group
+
+// --- Cursor movement ---
+bool gb_left(gapbuf_t *gb);
+bool gb_right(gapbuf_t *gb);
+void gb_move_to(gapbuf_t *gb, int pos);
+
+#endif
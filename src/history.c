@@ -0,0 +1,392 @@
+#include "history.h"
+#include "worker.h"
+#include "pico/stdlib.h"
+#include "log.h"
+#include "pico/flash.h"
+#include "hardware/flash.h"
+#include <string.h>
+
+#define HIST_REGION_SIZE (HIST_SECTORS * FLASH_SECTOR_SIZE)
+#define HIST_REGION_OFFS (PICO_FLASH_SIZE_BYTES - HIST_REGION_SIZE)
+#define HIST_PAGES (HIST_REGION_SIZE / FLASH_PAGE_SIZE)
+#define HIST_PAGES_PER_SECTOR (FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE)
+#define HIST_PAGE_DATA (FLASH_PAGE_SIZE - 8)
+#define HIST_REC_HDR 2
+#define HIST_SEQ_ERASED 0xFFFFFFFFu
+#define HIST_LOCKOUT_MS 50 // flash_safe_execute: time to get core1 out of flash
+
+typedef struct {
+    uint32_t seq;  // write order; erased flash reads 0xFFFFFFFF
+    uint16_t used; // bytes of data holding records
+    uint16_t crc;  // over seq, used and the records
+    uint8_t data[HIST_PAGE_DATA];
+} hist_page_t;
+
+_Static_assert(sizeof(hist_page_t) == FLASH_PAGE_SIZE, "a log page is one flash page");
+_Static_assert(sizeof(tt_bits_t) == 1, "records carry a one-byte table");
+
+// Index entry: where a record lives, plus its table so recall needs
+// no flash read for the result
+typedef struct {
+    uint16_t page;
+    uint8_t pos;
+    truth_table_t table;
+} hist_slot_t;
+
+// ---------------------------------------------------------
+// 1. FLASH PAGES
+// ---------------------------------------------------------
+static const hist_page_t *flash_page(uint32_t page) {
+    return (const hist_page_t *)(XIP_BASE + HIST_REGION_OFFS + page * FLASH_PAGE_SIZE);
+}
+
+// CRC-16/CCITT, a nibble at a time
+static uint16_t crc16(uint16_t crc, const void *data, size_t len) {
+    static const uint16_t table[16] = {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+        0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef,
+    };
+    const uint8_t *p = (const uint8_t *)data;
+    for (size_t i = 0; i < len; i++) {
+        crc = (uint16_t)((crc << 4) ^ table[(crc >> 12) ^ (p[i] >> 4)]);
+        crc = (uint16_t)((crc << 4) ^ table[(crc >> 12) ^ (p[i] & 0x0F)]);
+    }
+    return crc;
+}
+
+static uint16_t page_crc(const hist_page_t *pg) {
+    uint16_t crc = crc16(0xFFFF, &pg->seq, sizeof(pg->seq));
+    crc = crc16(crc, &pg->used, sizeof(pg->used));
+    return crc16(crc, pg->data, pg->used);
+}
+
+// Header looks written (cheap); the CRC is only checked when it matters
+static bool page_plausible(const hist_page_t *pg) {
+    return pg->seq != HIST_SEQ_ERASED && pg->used > 0 && pg->used <= HIST_PAGE_DATA;
+}
+
+static bool page_valid(const hist_page_t *pg) {
+    return page_plausible(pg) && pg->crc == page_crc(pg);
+}
+
+static bool page_blank(const hist_page_t *pg) {
+    const uint32_t *w = (const uint32_t *)pg;
+    for (unsigned i = 0; i < FLASH_PAGE_SIZE / 4; i++) {
+        if (w[i] != 0xFFFFFFFFu) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ---------------------------------------------------------
+// 2. INDEX
+// ---------------------------------------------------------
+static hist_slot_t slots[HIST_INDEX_LEN]; // oldest first
+static int slot_count = 0;
+
+static void index_push(uint16_t page, uint8_t pos, truth_table_t table) {
+    if (slot_count == HIST_INDEX_LEN) {
+        memmove(&slots[0], &slots[1], (HIST_INDEX_LEN - 1) * sizeof(slots[0]));
+        slot_count--;
+    }
+    slots[slot_count++] = (hist_slot_t){ page, pos, table };
+}
+
+// ---------------------------------------------------------
+// 3. RAM PAGES
+// ---------------------------------------------------------
+// Up to two pages wait for their flash write, oldest first; the
+// newest one is where records go.
+static hist_page_t stage[2];
+static uint16_t stage_at[2]; // region page each will be written to
+static int stage_first = 0;
+static int stage_n = 1;
+static uint32_t next_seq = 0;
+static uint32_t last_input_us = 0;
+static bool region_ok = false; // the log region is clear of the image
+static hist_stats_t stats;
+
+static int stage_fill(void) {
+    return (stage_first + stage_n - 1) % 2;
+}
+
+static const hist_page_t *staged(uint32_t page) {
+    for (int k = 0; k < stage_n; k++) {
+        int b = (stage_first + k) % 2;
+        if (stage_at[b] == page) {
+            return &stage[b];
+        }
+    }
+    return NULL;
+}
+
+// Forget entries on region pages [first, first + n) that are not
+// waiting in RAM
+static void index_drop(uint32_t first, uint32_t n) {
+    int out = 0;
+    for (int i = 0; i < slot_count; i++) {
+        uint32_t p = slots[i].page;
+        if (p < first || p >= first + n || staged(p)) {
+            slots[out++] = slots[i];
+        }
+    }
+    slot_count = out;
+}
+
+static void stage_open(int b, uint32_t page) {
+    memset(&stage[b], 0xFF, sizeof(stage[b]));
+    stage[b].used = 0;
+    stage_at[b] = HIST_PAGES;
+    index_drop(page, 1); // left over from the previous lap
+    stage_at[b] = (uint16_t)page;
+}
+
+static const hist_page_t *page_of(const hist_slot_t *s) {
+    const hist_page_t *pg = staged(s->page);
+    return pg ? pg : flash_page(s->page);
+}
+
+typedef struct {
+    uint32_t offs;
+    bool erase;
+    const hist_page_t *pg;
+} hist_write_t;
+
+static void hist_flash_op(void *param) {
+    const hist_write_t *w = (const hist_write_t *)param;
+    if (w->erase) {
+        flash_range_erase(w->offs, FLASH_SECTOR_SIZE);
+    }
+    flash_range_program(w->offs, (const uint8_t *)w->pg, FLASH_PAGE_SIZE);
+}
+
+// Program the oldest RAM page, erasing its sector first when it is the
+// sector's first page. flash_safe_execute locks core1 out and masks
+// interrupts for the duration, since nothing can run from flash
+// meanwhile; if core1 can't be locked out the page stays in RAM and
+// the write is tried again later. Returns false if nothing was written.
+static bool stage_write(void) {
+    int b = stage_first;
+    uint32_t page = stage_at[b];
+    hist_write_t w = {
+        .offs = HIST_REGION_OFFS + page * FLASH_PAGE_SIZE,
+        .erase = page % HIST_PAGES_PER_SECTOR == 0,
+        .pg = &stage[b],
+    };
+    uint32_t t0 = time_us_32();
+
+    if (!region_ok) {
+        return false;
+    }
+    stage[b].seq = next_seq;
+    stage[b].crc = page_crc(&stage[b]);
+    if (w.erase) {
+        index_drop(page, HIST_PAGES_PER_SECTOR);
+    }
+
+    if (flash_safe_execute(hist_flash_op, &w, HIST_LOCKOUT_MS) != PICO_OK) {
+        stats.write_failed++;
+        return false;
+    }
+    next_seq++;
+
+    stats.pages_written++;
+    stats.sectors_erased += w.erase ? 1u : 0u;
+    stats.flush_us = time_us_32() - t0;
+
+    if (stage_n == 2) {
+        stage_first ^= 1;
+        stage_n = 1;
+    }
+    else {
+        stage_open(b, (page + 1) % HIST_PAGES);
+    }
+    return true;
+}
+
+// ---------------------------------------------------------
+// 4. MOUNT
+// ---------------------------------------------------------
+#if PICO_ON_DEVICE
+extern char __flash_binary_end; // from the SDK linker script
+#endif
+
+// Nothing reserves the region in the linker script, so an image that
+// grows into it would be erased by the log
+static bool region_clear(void) {
+#if PICO_ON_DEVICE
+    return (uintptr_t)&__flash_binary_end <= XIP_BASE + HIST_REGION_OFFS;
+#else
+    return true;
+#endif
+}
+
+// Newest page with a good CRC: highest plausible sequence number first,
+// so normally only one page is checksummed
+static int find_newest(void) {
+    uint32_t limit = HIST_SEQ_ERASED;
+    while (true) {
+        int best = -1;
+        for (uint32_t p = 0; p < HIST_PAGES; p++) {
+            const hist_page_t *pg = flash_page(p);
+            if (page_plausible(pg) && pg->seq < limit && (best < 0 || pg->seq > flash_page(best)->seq)) {
+                best = (int)p;
+            }
+        }
+        if (best < 0 || page_valid(flash_page(best))) {
+            return best;
+        }
+        limit = flash_page(best)->seq;
+    }
+}
+
+// Walk back from the newest page, filling the index newest first
+static void rebuild_index(int newest) {
+    hist_slot_t found[HIST_INDEX_LEN];
+    int n = 0;
+    uint32_t last_seq = HIST_SEQ_ERASED;
+
+    for (uint32_t k = 0; k + 1 < HIST_PAGES && n < HIST_INDEX_LEN; k++) {
+        uint32_t p = ((uint32_t)newest + HIST_PAGES - k) % HIST_PAGES;
+        const hist_page_t *pg = flash_page(p);
+        if (!page_valid(pg)) {
+            continue; // erased, or a torn write
+        }
+        if (pg->seq >= last_seq) {
+            break; // out of order: not part of this log
+        }
+        last_seq = pg->seq;
+
+        uint8_t pos[HIST_PAGE_DATA / (HIST_REC_HDR + 1)];
+        int recs = 0;
+        for (unsigned at = 0; at + HIST_REC_HDR <= pg->used;) {
+            unsigned len = pg->data[at];
+            if (len == 0 || at + HIST_REC_HDR + len > pg->used) {
+                break;
+            }
+            pos[recs++] = (uint8_t)at;
+            at += HIST_REC_HDR + len;
+        }
+        while (recs > 0 && n < HIST_INDEX_LEN) {
+            uint8_t at = pos[--recs];
+            found[n++] = (hist_slot_t){ (uint16_t)p, at, { pg->data[at + 1] } };
+        }
+    }
+
+    slot_count = 0;
+    while (n > 0) {
+        slots[slot_count++] = found[--n];
+    }
+}
+
+void history_init(void) {
+    int newest = -1;
+    uint32_t page = 0;
+
+    memset(&stats, 0, sizeof(stats));
+    next_seq = 0;
+    slot_count = 0;
+    region_ok = region_clear();
+    if (region_ok) {
+        newest = find_newest();
+    }
+    else {
+        log_printf("HIST region overlaps the image: history kept in RAM only\n");
+    }
+    if (newest >= 0) {
+        next_seq = flash_page(newest)->seq + 1;
+        rebuild_index(newest);
+        page = ((uint32_t)newest + 1) % HIST_PAGES;
+    }
+
+    // Resuming mid-sector needs the rest of it blank (a write cut off by
+    // a reset leaves a dirty page); otherwise start on the next sector
+    for (uint32_t p = page; region_ok && p % HIST_PAGES_PER_SECTOR != 0; p++) {
+        if (!page_blank(flash_page(p))) {
+            page = (p / HIST_PAGES_PER_SECTOR + 1) * HIST_PAGES_PER_SECTOR % HIST_PAGES;
+            break;
+        }
+    }
+
+    stage_first = 0;
+    stage_n = 1;
+    stage_open(0, page);
+    last_input_us = time_us_32();
+}
+
+// ---------------------------------------------------------
+// 5. PUBLIC API
+// ---------------------------------------------------------
+void history_append(const char *expr, truth_table_t table) {
+    size_t len = strlen(expr);
+    if (len == 0 || len > HIST_PAGE_DATA - HIST_REC_HDR) {
+        return;
+    }
+
+    int b = stage_fill();
+    if (stage[b].used + HIST_REC_HDR + len > HIST_PAGE_DATA) {
+        if (stage_n == 2) {
+            stats.dropped++;
+            return;
+        }
+        int next = b ^ 1;
+        stage_n = 2;
+        stage_open(next, (stage_at[b] + 1u) % HIST_PAGES);
+        b = next;
+    }
+
+    uint16_t at = stage[b].used;
+    stage[b].data[at] = (uint8_t)len;
+    stage[b].data[at + 1] = table.bits;
+    memcpy(&stage[b].data[at + HIST_REC_HDR], expr, len);
+    stage[b].used = (uint16_t)(at + HIST_REC_HDR + len);
+
+    index_push(stage_at[b], (uint8_t)at, table);
+    last_input_us = time_us_32();
+}
+
+int history_count(void) {
+    return slot_count;
+}
+
+bool history_get(int n, hist_entry_t *out) {
+    if (n < 0 || n >= slot_count) {
+        return false;
+    }
+    const hist_slot_t *s = &slots[slot_count - 1 - n];
+    const uint8_t *rec = &page_of(s)->data[s->pos];
+    out->expr = (const char *)&rec[HIST_REC_HDR];
+    out->len = rec[0];
+    out->table = s->table;
+    return true;
+}
+
+void history_note_input(void) {
+    last_input_us = time_us_32();
+}
+
+void history_service(void) {
+    if (stage[stage_fill()].used == 0 && stage_n == 1) {
+        return;
+    }
+    if (time_us_32() - last_input_us < HIST_FLUSH_IDLE_US || worker_busy()) {
+        return; // still in use, or core1 has a job and can't be parked
+    }
+    history_flush();
+}
+
+void history_flush(void) {
+    while (stage_n == 2) {
+        if (!stage_write()) {
+            return;
+        }
+    }
+    if (stage[stage_first].used > 0) {
+        stage_write();
+    }
+}
+
+void history_get_stats(hist_stats_t *out) {
+    *out = stats;
+}
@@ -0,0 +1,57 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "truthtable.h"
+
+// Persistent expression history in the last HIST_SECTORS sectors of
+// flash, kept as an append-only log of pages:
+//
+//   page   seq (u32) | used (u16) | crc16 (u16) | records...
+//   record len (u8) | packed table (u8, bit n = row n) | expr (len bytes)
+//
+// New records collect in a RAM page that is programmed whole once the
+// keypad, knob and serial batch have been idle for a while, so flash is
+// only ever written a page at a time and never while someone is typing
+// or sweeping the knob; a second RAM page takes over if the first fills
+// before then.
+// Pages are used round-robin through the region and a sector is erased
+// just before its first page is reused, so every sector wears evenly and
+// the oldest entries are the ones that go. At boot the newest page is
+// found by sequence number and the RAM index is rebuilt from the tail
+// of the log. If the program image reaches into the region, nothing is
+// written and the history only lasts until reset.
+
+#ifndef HIST_SECTORS
+#define HIST_SECTORS 8 // 32 KiB at the end of flash, kept clear of the image
+#endif
+#define HIST_INDEX_LEN 32      // recent entries reachable without a scan
+#define HIST_FLUSH_IDLE_US 1000000u // input quiet time before a page write
+
+typedef struct {
+    const char *expr; // in flash or the RAM page, not NUL-terminated
+    uint8_t len;
+    truth_table_t table;
+} hist_entry_t;
+
+typedef struct {
+    uint32_t pages_written;
+    uint32_t sectors_erased;
+    uint32_t flush_us; // time spent in the last page write (erase included)
+    uint32_t dropped;  // records lost because both RAM pages were full
+    uint32_t write_failed; // writes put off: core1 could not be locked out
+} hist_stats_t;
+
+void history_init(void); // mount: find the log head, rebuild the index
+
+void history_append(const char *expr, truth_table_t table);
+int history_count(void);                   // entries in the index
+bool history_get(int n, hist_entry_t *out); // 0 = newest
+
+void history_note_input(void); // keypad, knob or batch activity: hold page writes off
+void history_service(void);    // main loop: write the RAM page when due
+void history_flush(void);      // write the RAM page now
+void history_get_stats(hist_stats_t *out);
+
+#endif
@@ -1,4 +1,5 @@
 #include "keypad_mapped.h"
+#include "events.h"
 #include "pico/stdlib.h"
 #include "hardware/gpio.h"
 #include "hardware/irq.h"
@@ -22,7 +23,9 @@
 // ---------------------------------------------------------
 // 2. QUEUE IMPLEMENTATION
 // ---------------------------------------------------------
+#ifndef Q_SIZE
 #define Q_SIZE 32
+#endif
 typedef struct {
     uint16_t buffer[Q_SIZE];
     int head;
@@ -43,6 +46,7 @@ void key_push(uint16_t event) {
         key_q.buffer[key_q.head] = event;
         key_q.head = next;
     }
+    ev_post(EV_KEY);
 }
 
 bool key_pop(uint16_t *event) {
@@ -61,11 +65,19 @@ bool key_pop(uint16_t *event) {
 // Global state variables
 int col = -1;
 static bool state[16]; 
+static uint32_t press_time[16];  // timerawl at press, for autorepeat
+static uint16_t repeat_count[16]; // repeats emitted since press
 const char keymap[17] = "DCBA#9630852*741";
 
+#define SHIFT_KEY_INDEX 12 // '*' in keymap
+
+static uint32_t repeat_delay_us = 450000u;
+static uint32_t repeat_rate_us = 70000u;
+
 // Forward declarations
 void keypad_drive_column();
 void keypad_isr();
+static bool key_repeats(char raw_key, bool shifted);
 
 void keypad_init_pins() {
     for (uint gpio = COL0; gpio <= COL3; gpio++){
@@ -82,6 +94,8 @@ void keypad_init_pins() {
     
     for(int i = 0; i < 16; i++){
         state[i] = false;
+        press_time[i] = 0;
+        repeat_count[i] = 0;
     }
     col = -1;
 }
@@ -104,6 +118,11 @@ void keypad_init_timer() {
     timer_hw->alarm[1] = time + 2000;
 }
 
+void keypad_set_repeat(uint32_t delay_ms, uint32_t rate_ms) {
+    repeat_delay_us = delay_ms * 1000u;
+    repeat_rate_us = (rate_ms ? rate_ms : 1u) * 1000u;
+}
+
 void keypad_drive_column() {
     timer_hw->intr = (1u << 0); 
     col++;
@@ -129,23 +148,33 @@ void keypad_isr() {
         return;
     }
 
+    uint32_t now = timer_hw->timerawl;
+
     for (int r = 0; r < 4; r++){
         bool button_press_now = (rows >> r) & 0x1;
         int index = col * 4 + r; 
         bool was_pressed = state[index];
+        char ch = keymap[index];
+        uint16_t shift = (state[SHIFT_KEY_INDEX] && index != SHIFT_KEY_INDEX) ? KEY_EV_SHIFT : 0;
 
         if (button_press_now && !was_pressed){
             state[index] = true;
-            char ch = keymap[index];
-            // High byte 1 = Press
-            uint16_t event = (uint16_t)((1u << 8) | (uint8_t)ch);
+            press_time[index] = now;
+            repeat_count[index] = 0;
+            uint16_t event = (uint16_t)(KEY_EV_PRESS | shift | (uint8_t)ch);
+            key_push(event);
+        }
+        else if (button_press_now && key_repeats(ch, shift != 0)
+                 && now - press_time[index] >= repeat_delay_us + repeat_count[index] * repeat_rate_us){
+            // Held past the delay: emit repeats at the configured rate
+            repeat_count[index]++;
+            uint16_t event = (uint16_t)(KEY_EV_PRESS | KEY_EV_REPEAT | shift | (uint8_t)ch);
             key_push(event);
         }
         else if (!button_press_now && was_pressed){
             state[index] = false;
-            char ch = keymap[index];
-            // High byte 0 = Release
-            uint16_t event = (uint16_t)((0u << 8) | (uint8_t)ch); 
+            // No flags = Release
+            uint16_t event = (uint16_t)(uint8_t)ch; 
             key_push(event);
         }
     }
@@ -155,19 +184,64 @@ void keypad_isr() {
 // ---------------------------------------------------------
 // 4. MAPPING LOGIC
 // ---------------------------------------------------------
-const char* get_boolean_token(char raw_key) {
-    switch(raw_key) {
-        case '1': return "A";
-        case '2': return "B";
-        case '3': return "C";
-        case '8': return "&"; 
-        case '0': return "|"; 
-        case '4': return "!";   
-        case '5': return "^"; 
-        case '6': return "(";   
-        case 'B': return ")";   
-        case '#': return "\n";  
-        case 'D': return "\b";  
-        default: return NULL;   
+typedef struct {
+    char key;
+    const char *base;  // token with no modifier
+    const char *shift; // token while '*' is held (NULL = same as base)
+    bool repeat;       // autorepeat while held
+} keymap_entry_t;
+
+// '*' is the shift key and produces no token of its own.
+static const keymap_entry_t keymap_table[] = {
+    { '1', "A",  "!A", true  },
+    { '2', "B",  "!B", true  },
+    { '3', "C",  "!C", true  },
+    { '4', "!",  TOK_DELETE, true },
+    { '5', "^",  "^!", true  },
+    { '6', "(",  "((", true  },
+    { '8', "&",  "&!", true  },
+    { '0', "|",  "|!", true  },
+    { 'A', "!(", TOK_HIST_OLDER, false },
+    { 'B', ")",  "))", true  },
+    { '#', "\n", TOK_PROF_DUMP, false },
+    { 'D', "\b", TOK_CLEAR_TO_START, true },
+    { '7', TOK_CURSOR_LEFT,  TOK_CURSOR_HOME, true },
+    { '9', TOK_CURSOR_RIGHT, TOK_CURSOR_END,  true },
+    { 'C', TOK_UNDO, TOK_HIST_NEWER, true },
+};
+
+#define KEYMAP_ENTRIES (sizeof(keymap_table) / sizeof(keymap_table[0]))
+
+static const keymap_entry_t* keymap_lookup(char raw_key) {
+    for (unsigned i = 0; i < KEYMAP_ENTRIES; i++) {
+        if (keymap_table[i].key == raw_key) {
+            return &keymap_table[i];
+        }
     }
-}
\ No newline at end of file
+    return NULL;
+}
+
+static bool key_repeats(char raw_key, bool shifted) {
+    const keymap_entry_t *e = keymap_lookup(raw_key);
+    if (!e) return false;
+    // Shifted jumps (clear-to-start, home, end) gain nothing from
+    // repeating, and history recall steps one entry per press either way
+    if (shifted && e->shift && (e->shift[0] == TOK_CLEAR_TO_START[0]
+                                || e->shift[0] == TOK_CURSOR_HOME[0]
+                                || e->shift[0] == TOK_CURSOR_END[0]
+                                || e->shift[0] == TOK_HIST_OLDER[0]
+                                || e->shift[0] == TOK_HIST_NEWER[0])) return false;
+    return e->repeat;
+}
+
+const char* get_boolean_token(char raw_key) {
+    const keymap_entry_t *e = keymap_lookup(raw_key);
+    return e ? e->base : NULL;
+}
+
+const char* key_event_token(uint16_t event) {
+    const keymap_entry_t *e = keymap_lookup((char)(event & 0xFF));
+    if (!e) return NULL;
+    if ((event & KEY_EV_SHIFT) && e->shift) return e->shift;
+    return e->base;
+}
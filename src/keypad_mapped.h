@@ -4,16 +4,44 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+// --- Event Encoding ---
+// Low byte is the raw key char, high byte holds these flags.
+// A release event has no flags set.
+#define KEY_EV_PRESS  0x0100u
+#define KEY_EV_REPEAT 0x0200u // generated while a key is held
+#define KEY_EV_SHIFT  0x0400u // shift key ('*') was held at press time
+
+// Control tokens returned for editing keys
+#define TOK_CLEAR_TO_START "\x15"
+#define TOK_CURSOR_LEFT    "\x11"
+#define TOK_CURSOR_RIGHT   "\x12"
+#define TOK_CURSOR_HOME    "\x13"
+#define TOK_CURSOR_END     "\x14"
+#define TOK_UNDO           "\x1a"
+#define TOK_DELETE         "\x7f"
+#define TOK_PROF_DUMP      "\x10"
+#define TOK_HIST_OLDER     "\x0e"
+#define TOK_HIST_NEWER     "\x0f"
+
 // --- Initialization Functions ---
 void q_init(void);
 void keypad_init_pins(void);
 void keypad_init_timer(void);
 
+// Autorepeat timing for held keys (delay before first repeat, then period)
+void keypad_set_repeat(uint32_t delay_ms, uint32_t rate_ms);
+
 // --- Data Access ---
 // Pop an event from the queue. Returns true if event found.
 bool key_pop(uint16_t *event);
 
-// Translates a raw key char (e.g., '8') into a token (e.g., " & ")
+// Push an event as the scan ISR does (also used to replay traces)
+void key_push(uint16_t event);
+
+// Translates a raw key char (e.g., '8') into a base-layer token (e.g., "&")
 const char* get_boolean_token(char raw_key);
 
+// Translates a full event, honoring the shift layer
+const char* key_event_token(uint16_t event);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include "log.h"
+#include "pico/stdlib.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#if LIB_PICO_STDIO_USB
+#include "pico/stdio_usb.h"
+#include "tusb.h"
+#endif
+
+#define LOG_MSG_MAX 160
+
+static char ring[LOG_RING_LEN];
+static volatile uint32_t head = 0; // producer
+static volatile uint32_t tail = 0; // consumer
+static uint32_t dropped = 0;
+
+size_t log_free(void) {
+    return LOG_RING_LEN - (head - tail);
+}
+
+bool log_write(const void *data, size_t len) {
+    if (len > log_free()) {
+        dropped++;
+        return false;
+    }
+    const char *p = (const char *)data;
+    uint32_t h = head;
+    for (size_t i = 0; i < len; i++) {
+        ring[(h + i) % LOG_RING_LEN] = p[i];
+    }
+    head = h + (uint32_t)len; // publish after the bytes are in place
+    return true;
+}
+
+void log_printf(const char *fmt, ...) {
+    char msg[LOG_MSG_MAX];
+    char crlf[2 * LOG_MSG_MAX];
+
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(msg, sizeof(msg), fmt, ap);
+    va_end(ap);
+    if (n < 0) {
+        return;
+    }
+    if (n >= (int)sizeof(msg)) {
+        n = sizeof(msg) - 1; // truncated
+    }
+
+    int m = 0;
+    for (int i = 0; i < n; i++) {
+        if (msg[i] == '\n') {
+            crlf[m++] = '\r';
+        }
+        crlf[m++] = msg[i];
+    }
+    log_write(crlf, (size_t)m);
+}
+
+// How many bytes the host side can take right now without blocking
+static size_t log_sink_room(void) {
+#if LIB_PICO_STDIO_USB
+    if (!stdio_usb_connected()) {
+        return 0; // keep buffering until a host attaches
+    }
+    return tud_cdc_write_available();
+#else
+    return 32; // UART: a FIFO's worth per drain
+#endif
+}
+
+void log_drain(void) {
+    size_t room = log_sink_room();
+    uint32_t t = tail;
+
+    if (room == 0 || t == head) {
+        return;
+    }
+
+    while (room > 0 && t != head) {
+        putchar_raw(ring[t % LOG_RING_LEN]);
+        t++;
+        room--;
+    }
+    tail = t;
+    stdio_flush();
+}
+
+uint32_t log_dropped(void) {
+    return dropped;
+}
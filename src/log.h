@@ -0,0 +1,62 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Asynchronous logging. Messages are formatted into a ring buffer and
+// log_drain pushes them to stdio only as fast as the host takes them,
+// so serial output never stalls input handling or display updates.
+// When the ring is full a message is dropped whole and counted.
+//
+// Single producer / single consumer: log from core0 thread context
+// only (not from IRQ handlers or core1), and drain from the main loop.
+
+#define LOG_LEVEL_ERROR 0
+#define LOG_LEVEL_WARN  1
+#define LOG_LEVEL_INFO  2
+#define LOG_LEVEL_DEBUG 3
+
+// Levels above this compile to nothing
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+#define LOG_RING_LEN 2048 // power of two
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) log_printf(__VA_ARGS__)
+#else
+#define LOG_ERROR(...) ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(...) log_printf(__VA_ARGS__)
+#else
+#define LOG_WARN(...) ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(...) log_printf(__VA_ARGS__)
+#else
+#define LOG_INFO(...) ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) log_printf(__VA_ARGS__)
+#else
+#define LOG_DEBUG(...) ((void)0)
+#endif
+
+// Format a text message; '\n' goes out as "\r\n"
+void log_printf(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+// Queue raw bytes unchanged (binary-safe); returns false if dropped
+bool log_write(const void *data, size_t len);
+
+size_t log_free(void);      // bytes of room in the ring
+void log_drain(void);       // push queued bytes out without blocking
+uint32_t log_dropped(void); // messages lost to a full ring
+
+#endif
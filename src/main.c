@@ -1,467 +1,107 @@
 #include <stdio.h>
-#include <string.h>
 #include "pico/stdlib.h"
 #include "keypad_mapped.h"
 #include "chardisp.h" // <-- make sure this declares init_chardisp_pins, cd_init, cd_display1, cd_display2
-#include "outputbuilder.h"
-#include "hardware/adc.h"
+#include "events.h"
+#include "ui.h"
+#include "worker.h"
+#include "serialcmd.h"
+#include "log.h"
+#include "prof.h"
+#include "memstat.h"
+#include "trace.h"
+#include "history.h"
+#include "clockgov.h"
 
 const bool USING_LCD = true; // Set to true if using LCD, false if using OLED, for check_wiring.
-const int SEG7_DMA_CHANNEL = 5; 
+const int SPI_DISP_DMA_CHANNEL = 5; // DMA channel feeding the LCD SPI TX FIFO
+const int KNOB_DMA_CHANNEL = 6;     // DMA channel streaming ADC samples
 
 const int SPI_DISP_SCK = 34; // Replace with your SCK pin number for the LCD/OLED display
 const int SPI_DISP_CSn = 33; // Replace with your CSn pin number for the LCD/OLED display
 const int SPI_DISP_TX = 35; // Replace with your TX pin number for the LCD/OLED display
 
-#define LCD_COLS 16
-#define EXPR_MAX 63
-#define ADC_PIN 45    // pot connected to GPIO 45 (from Lab 4)
-#define ADC_CHANNEL 5 // ADC channel 5 on RP2350
+#define TICK_MS 10    // knob sampling / compositor tick
 
-static uint8_t last_outputs[8];
-static bool have_table = false;
-static int current_row = 0;
-static char last_expr[EXPR_MAX + 1];
-
-static char expr_buf[EXPR_MAX + 1];
-static int expr_len = 0;
-
-static char lcd_line1[LCD_COLS + 1];
-static char lcd_line2[LCD_COLS + 1];
-static int lcd_row = 0; // 0 = first line, 1 = second line
-static int lcd_col = 0; // 0..15
-
-static bool syntax_error_shown = false;
-
-static void expr_clear(void)
-{
-    expr_len = 0;
-    expr_buf[0] = '\0';
-}
-
-static void lcd_clear_buffers(void);
-static void lcd_sync(void);
-static void lcd_put_char(char c);
-
-// ---------------- LCD helper functions ----------------
-static void reset_input_and_lcd(void)
-{
-    expr_clear();            // clears expr_buf and expr_len (you already use this)
-    have_table = false;
-    current_row = 0;
-
-    lcd_clear_buffers();
-    lcd_row = 0;
-    lcd_col = 0;
-    lcd_sync();
-}
-
-// Show error message and mark that we’re in “error mode”
-static void show_syntax_error(int err)
-{
-    have_table = false;
-    expr_clear();  // wipe any garbage expression
-
-    lcd_clear_buffers();
-    lcd_row = 0;
-    lcd_col = 0;
-
-    const char *msg = "SYNTAX ERROR";
-    for (int i = 0; msg[i] && i < LCD_COLS; ++i)
-    {
-        lcd_put_char(msg[i]);
-    }
-    lcd_sync();
-
-    printf("Error parsing expression (code %d)\n", err);
-
-    // Remember that the last thing we showed was an error
-    syntax_error_shown = true;
-}
-
-static void lcd_clear_buffers(void)
-{
-    memset(lcd_line1, ' ', LCD_COLS);
-    memset(lcd_line2, ' ', LCD_COLS);
-    lcd_line1[LCD_COLS] = '\0';
-    lcd_line2[LCD_COLS] = '\0';
-    lcd_row = 0;
-    lcd_col = 0;
-}
-
-static void lcd_sync(void)
-{
-    cd_display1(lcd_line1);
-    cd_display2(lcd_line2);
-}
-
-// Put a single printable character at current cursor position,
-// with automatic wrap from line 1 -> line 2.
-static void lcd_put_char(char c)
-{
-    if (c == '\n')
-    {
-        // ENTER just goes to the start of line 2
-        lcd_row = 1;
-        lcd_col = 0;
-        return;
-    }
-
-    // If first line is full, wrap to second line
-    if (lcd_row == 0 && lcd_col >= LCD_COLS)
-    {
-        lcd_row = 1;
-        lcd_col = 0;
-    }
-
-    // If second line is full, you can either:
-    //  - ignore extra characters, or
-    //  - overwrite the last one. For now, ignore.
-    if (lcd_row == 1 && lcd_col >= LCD_COLS)
-    {
-        return;
-    }
-
-    if (lcd_row == 0)
-    {
-        lcd_line1[lcd_col++] = c;
-    }
-    else
-    {
-        lcd_line2[lcd_col++] = c;
-    }
-
-    lcd_sync();
-}
-
-// Handle multi-character token (like " & ", " ^ ", etc.)
-// but ignore spaces so LCD shows "&", "|", "^" compactly.
-static void lcd_put_token(const char *tok)
-{
-    for (int i = 0; tok[i] != '\0'; ++i)
-    {
-        char c = tok[i];
-
-        // Skip spaces so " & " prints as just '&' on LCD
-        if (c == ' ')
-            continue;
-
-        lcd_put_char(c);
-    }
-}
-
-// Handle backspace on LCD
-static void lcd_backspace(void)
-{
-    // Nothing to delete
-    if (lcd_row == 0 && lcd_col == 0)
-    {
-        return;
-    }
-
-    if (lcd_col > 0)
-    {
-        lcd_col--;
-    }
-    else
-    {
-        // At col 0 on line 2 -> go to end of line 1
-        if (lcd_row == 1)
-        {
-            lcd_row = 0;
-            lcd_col = LCD_COLS - 1;
-        }
-    }
-
-    if (lcd_row == 0)
-    {
-        lcd_line1[lcd_col] = ' ';
-    }
-    else
-    {
-        lcd_line2[lcd_col] = ' ';
-    }
-
-    lcd_sync();
-}
-
-// For ENTER (#) – clear and start over
-// static void lcd_handle_enter(void)
-// {
-//     lcd_clear_buffers();
-//     lcd_sync();
-// }
-
-// static void lcd_show_truth_table(const char *expr, const uint8_t outputs[8])
-// {
-//     // Clear screen
-//     lcd_clear_buffers();
-
-//     // Line 1: expression (truncated to 16 chars)
-//     lcd_row = 0;
-//     lcd_col = 0;
-//     for (int i = 0; i < LCD_COLS && expr[i] != '\0'; ++i)
-//     {
-//         lcd_put_char(expr[i]);
-//     }
-
-//     // Line 2: truth vector (8 bits as 0/1)
-//     lcd_row = 1;
-//     lcd_col = 0;
-//     for (int i = 0; i < 8 && lcd_col < LCD_COLS; ++i)
-//     {
-//         lcd_put_char(outputs[i] ? '1' : '0'); // or 'T'/'F' if you prefer
-//     }
-
-//     lcd_sync();
-// }
-
-// Show a single row: expression on line 1, selected (A,B,C,F) on line 2
-static void lcd_show_row(const char *expr,
-                         const uint8_t outputs[8],
-                         int row)
+static void display_done_cb(void)
 {
-    lcd_clear_buffers();
-
-    // Line 1: expression (truncated)
-    lcd_row = 0;
-    lcd_col = 0;
-    for (int i = 0; i < LCD_COLS && expr[i] != '\0'; ++i)
-    {
-        lcd_put_char(expr[i]);
-    }
-
-    // Figure out A,B,C for this row index
-    int A = (row >> 2) & 1;
-    int B = (row >> 1) & 1;
-    int C = (row >> 0) & 1;
-    int F = outputs[row] ? 1 : 0;
-
-    // Line 2: e.g. "r3:101 F=0"
-    lcd_row = 1;
-    lcd_col = 0;
-
-    char line[17];
-    snprintf(line, sizeof(line), "r%d:%d%d%d F=%d", row, A, B, C, F);
-
-    for (int i = 0; line[i] != '\0' && i < LCD_COLS; ++i)
-    {
-        lcd_put_char(line[i]);
-    }
-
-    lcd_sync();
+    ev_post(EV_DISPLAY);
 }
 
-// ADC knob helpers
-
-static void knob_adc_init(void)
+static void serial_chars_cb(void *param)
 {
-    adc_init();
-    adc_gpio_init(ADC_PIN);        // route GPIO to ADC
-    adc_select_input(ADC_CHANNEL); // select channel
+    (void)param;
+    ev_post(EV_SERIAL);
 }
 
-static uint16_t knob_adc_read_raw(void)
+static bool tick_cb(struct repeating_timer *t)
 {
-    // singleshot conversion
-    hw_set_bits(&adc_hw->cs, ADC_CS_START_ONCE_BITS);
-
-    // wait until conversion is done
-    while (!(adc_hw->cs & ADC_CS_READY_BITS))
-        ;
-
-    return (uint16_t)adc_hw->result; // 0..4095
+    (void)t;
+    ev_post(EV_TICK);
+    return true;
 }
 
-// Map 0..4095 -> 0..7
-static int knob_get_row_index(void)
-{
-    uint16_t val = knob_adc_read_raw();
-    int row = (val * 8) / 4096; // 4095 maps to 7
-    if (row < 0)
-    {
-        row = 0;
-    }
-    if (row > 7)
-    {
-        row = 7;
-    }
-
-    return row;
-}
 int main()
 {
-    stdio_init_all();
-    sleep_ms(2000);
-
-    // Initialize LCD SPI display
-    init_chardisp_pins();
-    cd_init();
-    lcd_clear_buffers();
-    lcd_sync();
-    expr_clear();
+    memstat_paint_core0();
+    prof_init();
 
-    // Initialize Keypad System
+    // Keypad first: it only needs GPIO and the timer, and from here on
+    // presses are queued even before the loop below starts
     q_init();
     keypad_init_pins();
     keypad_init_timer();
 
-    // Initialize ADC knob
-    knob_adc_init();
-    have_table = false;
-    current_row = 0;
-
-    printf("\n========================================\n");
-    printf("BOOLEAN EXPRESSION BUILDER READY\n");
-    printf("Key 1=A, 2=B, 3=C\n");
-    printf("Key 8=& (AND), 0=| (OR), 6=(\n");
-    printf("Key 4=! (NOT), 5=^ (XOR), B=)\n");
-    printf("Key #=ENTER, D=BACKSPACE\n");
-    printf("========================================\n\n> ");
-
-    while (true)
-    {
-        uint16_t event;
-
-        if (key_pop(&event))
-        {
-            bool is_pressed = (event >> 8) & 0xFF;
-            char raw_char = (char)(event & 0xFF);
-
-            if (is_pressed)
-            {
-                const char *boolean_str = get_boolean_token(raw_char);
-
-                if (boolean_str != NULL)
-                {
-                    // NEW: if we were showing a syntax error, clear LCD + expr
-                    if (syntax_error_shown)
-                    {
-                        reset_input_and_lcd();
-                        syntax_error_shown = false;
-                    }
-
-                    // ---------- 1. SERIAL ECHO ----------
-                    if (boolean_str[0] == '\b')
-                    {
-                        // Backspace on serial
-                        printf("\b \b");
-                    }
-                    else if (boolean_str[0] == '\n')
-                    {
-                        // ENTER on serial (we'll also evaluate)
-                        printf("\n");
-                    }
-                    else
-                    {
-                        // Normal token on serial
-                        printf("%s", boolean_str);
-                    }
-                    fflush(stdout);
-
-                    // ---------- 2. LCD ECHO + EXPR BUFFER ----------
-                    if (boolean_str[0] == '\b')
-                    {
-                        // BACKSPACE key: update LCD and expression buffer
-                        lcd_backspace();
-
-                        if (expr_len > 0)
-                        {
-                            expr_len--;
-                            expr_buf[expr_len] = '\0';
-                        }
-                    }
-                    else if (boolean_str[0] == '\n')
-                    {
-                        // ENTER key: finish expression and compute truth table
-
-                        // Null-terminate the expression
-                        expr_buf[expr_len] = '\0';
-
-                        uint8_t outputs[8];
-                        int err = build_truth_table(expr_buf, outputs);
-
-                        if (err == ERR_OK)
-                        {
-                            // Save outputs and expression for knob-based viewing
-                            memcpy(last_outputs, outputs, 8);
-                            strncpy(last_expr, expr_buf, EXPR_MAX);
-                            last_expr[EXPR_MAX] = '\0';
-
-                            have_table = true;
-
-                            // Initial row based on current knob position
-                            int row = knob_get_row_index();
-                            current_row = row;
-                            lcd_show_row(last_expr, last_outputs, current_row);
-
-                            // Also print full truth table on serial
-                            printf("Truth table (000..111): ");
-                            for (int i = 0; i < 8; ++i)
-                            {
-                                printf("%d", outputs[i]);
-                            }
-                            printf("\n");
-                        }
-                        else
-                        {
-                            // Use the dedicated handler
-                            show_syntax_error(err);
-                        }
-
-                        // Start new prompt on serial
-                        printf("> ");
-                        fflush(stdout);
-
-                        // Reset expression for next time
-                        expr_clear();
-                    }
-                    else
-                    {
-                        // Normal token (A, B, C, &, |, !, ^, (, ))
-
-                        // If we were in table view and expr is empty,
-                        // this is the start of a new expression: exit table mode.
-                        if (expr_len == 0 && have_table)
-                        {
-                            have_table = false;
-                            lcd_clear_buffers();
-                            lcd_sync();
-                        }
+    // LCD and knob. cd_init only queues the init sequence (power-on wait
+    // included); the DMA scheduler runs it while the rest of boot goes on
+    // and anything the UI draws meanwhile is flushed once it is done.
+    init_chardisp_pins();
+    cd_init();
+    ui_init();
 
-                        // 1) update LCD
-                        lcd_put_token(boolean_str);
+    // Full clock until boot is done; the first idle UI tick drops it
+    gov_init();
 
-                        // 2) append to expression buffer (skip spaces just in case)
-                        for (int i = 0; boolean_str[i] != '\0'; ++i)
-                        {
-                            char c = boolean_str[i];
-                            if (c == ' ')
-                                continue;
+    // Start the evaluation worker (core1 in dual-core builds)
+    worker_init();
+    serialcmd_init();
 
-                            if (expr_len < EXPR_MAX)
-                            {
-                                expr_buf[expr_len++] = c;
-                                expr_buf[expr_len] = '\0';
-                            }
-                            // else: silently drop extra chars to avoid overflow
-                        }
-                    }
-                }
-            }
-        }
+    // Mount the flash history (reads only: finds the log head and
+    // indexes the newest entries)
+    history_init();
 
-        // --- Knob update: if we have a valid table, use ADC to pick row ---
-        if (have_table)
-        {
-            int row = knob_get_row_index();
-            if (row != current_row)
-            {
-                current_row = row;
-                lcd_show_row(last_expr, last_outputs, current_row);
-            }
-        }
+    // USB CDC enumerates in the background; the log ring holds the
+    // banner and everything else until a host attaches
+    stdio_init_all();
 
-        tight_loop_contents();
+    LOG_INFO("\n========================================\n");
+    LOG_INFO("BOOLEAN EXPRESSION BUILDER READY\n");
+    LOG_INFO("Key 1=A, 2=B, 3=C\n");
+    LOG_INFO("Key 8=& (AND), 0=| (OR), 6=(\n");
+    LOG_INFO("Key 4=! (NOT), 5=^ (XOR), B=)\n");
+    LOG_INFO("Key A=!(, #=ENTER, D=BACKSPACE (hold to repeat)\n");
+    LOG_INFO("Key 7/9=cursor left/right, C=UNDO\n");
+    LOG_INFO("Hold * for: !A !B !C &! |! ^! (( )), *+D=CLEAR TO START\n");
+    LOG_INFO("            *+7=HOME, *+9=END, *+4=DELETE, *+#=PROFILE\n");
+    LOG_INFO("            *+A/*+C=HISTORY older/newer\n");
+    LOG_INFO("Serial: ':batch hex' / ':batch bin' to stream expressions\n");
+    LOG_INFO("========================================\n\n> ");
+
+    // Event sources: keypad ISR posts EV_KEY itself
+    static struct repeating_timer tick_timer;
+    add_repeating_timer_ms(TICK_MS, tick_cb, NULL, &tick_timer);
+    cd_set_done_callback(display_done_cb);
+    stdio_set_chars_available_callback(serial_chars_cb, NULL);
+
+    LOG_INFO("BOOT ready_us=%lu\n", (unsigned long)time_us_32());
+
+    // Sleep until an event arrives, then run its handler. Every wakeup
+    // also moves queued serial output along as fast as the host allows.
+    while (true)
+    {
+        ev_dispatch(ui_handlers);
+        trace_service();
+        log_drain();
+        serialcmd_service(); // batch output may have been waiting for log room
     }
 }
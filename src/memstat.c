@@ -0,0 +1,75 @@
+#include "memstat.h"
+#include "log.h"
+#include "pico/stdlib.h"
+
+#if PICO_ON_DEVICE
+
+#define MEMSTAT_PATTERN 0x5AC3C35Au
+
+// Linker script symbols
+extern uint32_t __StackBottom;
+extern uint32_t __StackTop;
+extern uint32_t __StackOneBottom;
+extern uint32_t __StackOneTop;
+extern uint32_t __data_start__;
+extern uint32_t __data_end__;
+extern uint32_t __bss_start__;
+extern uint32_t __bss_end__;
+
+static void paint(uint32_t *from, uint32_t *to) {
+    for (uint32_t *p = from; p < to; p++) {
+        *p = MEMSTAT_PATTERN;
+    }
+}
+
+void memstat_paint_core0(void) {
+    uint32_t *sp;
+    __asm volatile ("mov %0, sp" : "=r" (sp));
+    // Stay clear of our own live frame
+    paint(&__StackBottom, sp - 16);
+}
+
+void memstat_paint_core1(void) {
+    paint(&__StackOneBottom, &__StackOneTop);
+}
+
+uint32_t memstat_stack_size(int core) {
+    if (core == 0) {
+        return (uint32_t)((uintptr_t)&__StackTop - (uintptr_t)&__StackBottom);
+    }
+    return (uint32_t)((uintptr_t)&__StackOneTop - (uintptr_t)&__StackOneBottom);
+}
+
+uint32_t memstat_stack_peak(int core) {
+    uint32_t *p = core == 0 ? &__StackBottom : &__StackOneBottom;
+    uint32_t *top = core == 0 ? &__StackTop : &__StackOneTop;
+
+    while (p < top && *p == MEMSTAT_PATTERN) {
+        p++;
+    }
+    return (uint32_t)((uintptr_t)top - (uintptr_t)p);
+}
+
+void memstat_report(void) {
+    for (int core = 0; core < 2; core++) {
+        LOG_INFO("MEM stack%d %lu / %lu bytes\n", core,
+                 (unsigned long)memstat_stack_peak(core),
+                 (unsigned long)memstat_stack_size(core));
+    }
+    LOG_INFO("MEM data %lu bss %lu bytes\n",
+             (unsigned long)((uintptr_t)&__data_end__ - (uintptr_t)&__data_start__),
+             (unsigned long)((uintptr_t)&__bss_end__ - (uintptr_t)&__bss_start__));
+}
+
+#else
+
+// Host builds: the OS owns the stack
+void memstat_paint_core0(void) {}
+void memstat_paint_core1(void) {}
+uint32_t memstat_stack_size(int core) { (void)core; return 0; }
+uint32_t memstat_stack_peak(int core) { (void)core; return 0; }
+void memstat_report(void) {
+    LOG_INFO("MEM stack tracking is device-only\n");
+}
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef MEMSTAT_H
+#define MEMSTAT_H
+
+#include <stdint.h>
+
+// Stack high-water marks. The unused part of each core's stack is
+// painted with a pattern at boot; the peak is found later by scanning
+// for the first overwritten word. Static .data/.bss per module is
+// reported at build time by tools/memreport.py.
+
+void memstat_paint_core0(void); // call first thing in main()
+void memstat_paint_core1(void); // call before core1 is launched
+
+uint32_t memstat_stack_size(int core);
+uint32_t memstat_stack_peak(int core); // bytes ever used
+
+void memstat_report(void); // stacks and section totals to the log
+
+#endif
@@ -1,4 +1,5 @@
 #include "outputbuilder.h"
+#include "prof.h"
 #include <stdint.h>
 #include <stdbool.h>
 #include <ctype.h>
@@ -23,7 +24,9 @@ typedef struct
     char var; // 'A', 'B', or 'C' for TOK_VAR, undefined otherwise
 } Token;
 
+#ifndef MAX_TOKENS
 #define MAX_TOKENS 64
+#endif
 
 // error codes
 #define ERR_OK 0
@@ -132,7 +135,9 @@ typedef struct Node
     struct Node *right;
 } Node;
 
+#ifndef MAX_NODES
 #define MAX_NODES 64
+#endif
 
 static Node node_pool[MAX_NODES];
 static int node_count = 0;
@@ -422,12 +427,14 @@ int eval_ast(const Node *root, int A, int B, int C)
 
 // public API: build_truth_table
 
-int build_truth_table(const char *expr, uint8_t outputs[8])
+int build_truth_table(const char *expr, truth_table_t *table)
 {
     Token tokens[MAX_TOKENS];
     int token_count = 0;
 
+    PROF_BEGIN(PROF_TOKENIZE);
     int tok_err = tokenize(expr, tokens, MAX_TOKENS, &token_count);
+    PROF_END(PROF_TOKENIZE);
     if (tok_err != ERR_OK)
     {
         return tok_err; // invalid char or token overflow
@@ -441,7 +448,9 @@ int build_truth_table(const char *expr, uint8_t outputs[8])
     p.count = token_count;
     p.error = ERR_OK;
 
+    PROF_BEGIN(PROF_PARSE);
     Node *root = parse_expr(&p);
+    PROF_END(PROF_PARSE);
     if (!root || p.error != ERR_OK)
     {
         return p.error ? p.error : ERR_SYNTAX;
@@ -453,23 +462,21 @@ int build_truth_table(const char *expr, uint8_t outputs[8])
         return ERR_SYNTAX;
     }
 
-    // evalfor all 8 combinations into a temp buffer first
-    uint8_t tmp[8];
-    for (int row = 0; row < 8; ++row)
+    // eval all 8 combinations into a local table first
+    truth_table_t tmp = { 0 };
+    PROF_BEGIN(PROF_EVAL);
+    for (unsigned row = 0; row < TT_ROWS; ++row)
     {
         int A = (row >> 2) & 1; // MSB
         int B = (row >> 1) & 1;
         int C = (row >> 0) & 1; // LSB
 
-        int v = eval_ast(root, A, B, C);
-        tmp[row] = (uint8_t)(v ? 1 : 0);
+        tt_set(&tmp, row, eval_ast(root, A, B, C) != 0);
     }
+    PROF_END(PROF_EVAL);
 
-    // only copy to outputs on success
-    for (int i = 0; i < 8; ++i)
-    {
-        outputs[i] = tmp[i];
-    }
+    // only write the caller's table on success
+    *table = tmp;
 
     return ERR_OK; // success
 }
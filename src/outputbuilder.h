@@ -2,6 +2,7 @@
 #define OUTPUTBUILDER_H
 
 #include <stdint.h>
+#include "truthtable.h"
 
 // error codes
 #define ERR_OK 0
@@ -10,6 +11,7 @@
 #define ERR_TOKEN_OVERFLOW 3
 #define ERR_NODE_POOL 4
 
-int build_truth_table(const char *expr, uint8_t outputs[8]);
+// Fills *table only on success
+int build_truth_table(const char *expr, truth_table_t *table);
 
 #endif
@@ -0,0 +1,124 @@
+#include "prof.h"
+
+#if PROF_ENABLE
+
+#include "log.h"
+#include "hardware/sync.h"
+
+// One table per core, written only by its own core: core0 runs the UI
+// probes and core1 the evaluation stages, and neither may tear the
+// other's 64-bit sum or min/max. seq is odd while the owner updates, so
+// a reader on the other core retries instead of taking half an update.
+// A reset only bumps reset_gen; each core clears its own table on its
+// next record, and a table from an older generation reads as empty.
+#if PICO_ON_DEVICE
+#define PROF_CORES NUM_CORES
+#define prof_core() get_core_num()
+#else
+#define PROF_CORES 1
+#define prof_core() 0u
+#endif
+
+typedef struct {
+    volatile uint32_t seq;
+    uint32_t gen;
+    prof_stat_t stats[PROF_COUNT];
+} prof_table_t;
+
+static prof_table_t tables[PROF_CORES];
+static volatile uint32_t reset_gen = 0;
+
+static const char *const prof_names[PROF_COUNT] = {
+    [PROF_TOKENIZE] = "tokenize",
+    [PROF_PARSE] = "parse",
+    [PROF_EVAL] = "eval",
+    [PROF_LCD_SYNC] = "lcd_sync",
+    [PROF_ADC_READ] = "adc_read",
+    [PROF_KEY] = "key",
+    [PROF_KNOB_STEP] = "knob",
+};
+
+void prof_init(void) {
+#if PICO_ON_DEVICE
+    m33_hw->demcr |= M33_DEMCR_TRCENA_BITS;
+    m33_hw->dwt_cyccnt = 0;
+    m33_hw->dwt_ctrl |= M33_DWT_CTRL_CYCCNTENA_BITS;
+#endif
+}
+
+void prof_record(prof_id_t id, uint32_t ticks) {
+    prof_table_t *t = &tables[prof_core()];
+    t->seq++;
+    __dmb();
+    if (t->gen != reset_gen) {
+        for (int i = 0; i < PROF_COUNT; i++) {
+            t->stats[i] = (prof_stat_t){ 0 };
+        }
+        t->gen = reset_gen;
+    }
+
+    prof_stat_t *s = &t->stats[id];
+    if (s->count == 0 || ticks < s->min) {
+        s->min = ticks;
+    }
+    if (ticks > s->max) {
+        s->max = ticks;
+    }
+    s->count++;
+    s->sum += ticks;
+    __dmb();
+    t->seq++;
+}
+
+void prof_reset(void) {
+    reset_gen++;
+    __dmb();
+}
+
+// Consistent copy of one core's entry
+static prof_stat_t prof_read(const prof_table_t *t, prof_id_t id) {
+    prof_stat_t s;
+    uint32_t seq;
+    do {
+        seq = t->seq;
+        __dmb();
+        s = t->gen == reset_gen ? t->stats[id] : (prof_stat_t){ 0 };
+        __dmb();
+    } while ((seq & 1u) || seq != t->seq);
+    return s;
+}
+
+void prof_get(prof_id_t id, prof_stat_t *out) {
+    *out = (prof_stat_t){ 0 };
+    for (int c = 0; c < PROF_CORES; c++) {
+        prof_stat_t s = prof_read(&tables[c], id);
+        if (s.count == 0) {
+            continue;
+        }
+        if (out->count == 0 || s.min < out->min) {
+            out->min = s.min;
+        }
+        if (s.max > out->max) {
+            out->max = s.max;
+        }
+        out->count += s.count;
+        out->sum += s.sum;
+    }
+}
+
+void prof_dump(void) {
+#if PICO_ON_DEVICE
+    LOG_INFO("PROF probe count min avg max (cycles)\n");
+#else
+    LOG_INFO("PROF probe count min avg max (ns)\n");
+#endif
+    for (int i = 0; i < PROF_COUNT; i++) {
+        prof_stat_t s;
+        prof_get((prof_id_t)i, &s);
+        uint32_t avg = s.count ? (uint32_t)(s.sum / s.count) : 0;
+        LOG_INFO("PROF %-8s %lu %lu %lu %lu\n", prof_names[i], (unsigned long)s.count,
+                 (unsigned long)s.min, (unsigned long)avg, (unsigned long)s.max);
+    }
+}
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef PROF_H
+#define PROF_H
+
+#include <stdint.h>
+
+// Lightweight profiling probes. PROF_BEGIN/PROF_END bracket a region
+// and accumulate count/min/max/sum per probe in a table per core;
+// prof_get and prof_dump merge the cores. On the device the unit is
+// CPU cycles (DWT cycle counter); on the host it is nanoseconds from
+// the monotonic clock. Build with PROF_ENABLE=0 and every probe
+// compiles to nothing.
+
+#ifndef PROF_ENABLE
+#define PROF_ENABLE 1
+#endif
+
+typedef enum {
+    PROF_TOKENIZE = 0,
+    PROF_PARSE,
+    PROF_EVAL,      // truth table evaluation over all rows
+    PROF_LCD_SYNC,  // compositor flush (diff + queue frames)
+    PROF_ADC_READ,  // knob ring median
+    PROF_KEY,       // one keypad event, pop to back buffer
+    PROF_KNOB_STEP, // knob row change to back buffer
+    PROF_COUNT
+} prof_id_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+} prof_stat_t;
+
+#if PROF_ENABLE
+
+#include "pico/stdlib.h"
+#if PICO_ON_DEVICE
+#include "hardware/structs/m33.h"
+static inline uint32_t prof_now(void) {
+    return m33_hw->dwt_cyccnt;
+}
+#else
+#include <time.h>
+static inline uint32_t prof_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec);
+}
+#endif
+
+#define PROF_BEGIN(id) uint32_t prof_t0_##id = prof_now()
+#define PROF_END(id) prof_record((id), prof_now() - prof_t0_##id)
+
+void prof_init(void); // per core: enables that core's cycle counter
+void prof_record(prof_id_t id, uint32_t ticks);
+void prof_reset(void);
+void prof_get(prof_id_t id, prof_stat_t *out);
+void prof_dump(void); // one line per probe through the log ring
+
+#else
+
+#define PROF_BEGIN(id) ((void)0)
+#define PROF_END(id) ((void)0)
+
+static inline void prof_init(void) {}
+static inline void prof_reset(void) {}
+static inline void prof_dump(void) {}
+
+#endif
+
+#endif
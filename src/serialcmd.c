@@ -0,0 +1,328 @@
+#include "serialcmd.h"
+#include "outputbuilder.h"
+#include "log.h"
+#include "prof.h"
+#include "memstat.h"
+#include "trace.h"
+#include "history.h"
+#include "clockgov.h"
+#include "pico/stdlib.h"
+#include <stdio.h>
+#include <string.h>
+
+// ---------------------------------------------------------
+// 1. STATE
+// ---------------------------------------------------------
+#define SC_RX_LEN 512     // power of two
+#define SC_LINE_MAX 80
+#define SC_OUT_LEN 512
+#define SC_MAX_IN_FLIGHT (WORKER_SLOTS - 1) // leave a slot for the keypad
+#define SC_RESULT_MAX 8 // longest single result record
+
+typedef enum { SC_IDLE = 0, SC_BATCH_HEX, SC_BATCH_BIN, SC_REPLAY } sc_mode_t;
+
+static char rx[SC_RX_LEN];
+static uint32_t rx_head = 0;
+static uint32_t rx_tail = 0;
+
+static char line[SC_LINE_MAX + 1];
+static int line_len = 0;
+static bool line_too_long = false;
+static bool line_ready = false; // complete line waiting for a worker slot
+
+static char out[SC_OUT_LEN];
+static int out_len = 0;
+
+static sc_mode_t mode = SC_IDLE;
+static int in_flight = 0;
+static uint32_t batch_count = 0;
+static uint32_t batch_start_us = 0;
+static uint32_t batch_last_us = 0;
+
+// ---------------------------------------------------------
+// 2. OUTPUT BATCHING
+// ---------------------------------------------------------
+// Results collect in out[] and move to the log ring in one piece once
+// it has room. New jobs are only started while out[] can still take
+// every result in flight, so nothing is ever dropped.
+static void sc_flush(void) {
+    if (out_len > 0 && log_free() >= (size_t)out_len) {
+        log_write(out, (size_t)out_len);
+        out_len = 0;
+    }
+}
+
+static void sc_emit(const char *s, int n) {
+    if (out_len + n > SC_OUT_LEN) {
+        sc_flush();
+    }
+    if (out_len + n > SC_OUT_LEN) {
+        return; // only reachable for command replies with a stalled host
+    }
+    memcpy(out + out_len, s, (size_t)n);
+    out_len += n;
+}
+
+static bool sc_out_has_room(void) {
+    return out_len + (SC_MAX_IN_FLIGHT + 1) * SC_RESULT_MAX <= SC_OUT_LEN;
+}
+
+static void sc_emit_str(const char *s) {
+    sc_emit(s, (int)strlen(s));
+}
+
+_Static_assert(sizeof(tt_bits_t) == 1, ":batch bin records carry a one-byte table");
+
+static void sc_emit_result(int err, truth_table_t table) {
+    if (mode == SC_BATCH_BIN) {
+        char rec[2] = { (char)err, (char)table.bits };
+        sc_emit(rec, 2);
+    }
+    else if (err == ERR_OK) {
+        char rec[4 + TT_HEX_LEN] = { 'O', 'K', ' ' };
+        tt_to_hex(table, &rec[3]);
+        rec[3 + TT_HEX_LEN] = '\n';
+        sc_emit(rec, (int)sizeof(rec));
+    }
+    else {
+        char rec[6] = { 'E', 'R', 'R', ' ', (char)('0' + err), '\n' };
+        sc_emit(rec, 6);
+    }
+}
+
+// ---------------------------------------------------------
+// 3. COMMANDS
+// ---------------------------------------------------------
+// Newest first, as far as the log ring has room
+static void sc_history(void) {
+    hist_stats_t st;
+    history_get_stats(&st);
+    log_printf("HIST %d pages=%lu erases=%lu dropped=%lu failed=%lu\n", history_count(),
+               (unsigned long)st.pages_written, (unsigned long)st.sectors_erased,
+               (unsigned long)st.dropped, (unsigned long)st.write_failed);
+
+    hist_entry_t h;
+    int n = 0;
+    for (; history_get(n, &h) && log_free() > SC_LINE_MAX + 16; n++) {
+        char hex[TT_HEX_LEN + 1];
+        tt_to_hex(h.table, hex);
+        log_printf("%d %s %.*s\n", n, hex, h.len, h.expr);
+    }
+    log_printf("END %d\n", n);
+}
+
+static void sc_command(const char *cmd) {
+    char buf[48];
+
+    if (strcmp(cmd, ":batch hex") == 0 || strcmp(cmd, ":batch") == 0) {
+        mode = SC_BATCH_HEX;
+    }
+    else if (strcmp(cmd, ":batch bin") == 0) {
+        mode = SC_BATCH_BIN;
+    }
+    else if (strcmp(cmd, ":end") == 0 && mode == SC_REPLAY) {
+        mode = SC_IDLE;
+        trace_play_end(); // the report follows once the trace has played
+        return;
+    }
+    else if (strcmp(cmd, ":end") == 0) {
+        mode = SC_IDLE;
+        snprintf(buf, sizeof(buf), "END %lu\n", (unsigned long)batch_count);
+        sc_emit_str(buf);
+        return;
+    }
+    else if (strcmp(cmd, ":prof") == 0) {
+        sc_flush(); // keep replies ahead of the dump
+        prof_dump();
+        return;
+    }
+    else if (strcmp(cmd, ":prof reset") == 0) {
+        prof_reset();
+        sc_emit_str("OK\n");
+        return;
+    }
+    else if (strcmp(cmd, ":rec") == 0) {
+        trace_record_start();
+        sc_emit_str("OK\n");
+        return;
+    }
+    else if (strcmp(cmd, ":rec off") == 0) {
+        uint32_t n = trace_record_stop();
+        snprintf(buf, sizeof(buf), "END %lu %lu\n", (unsigned long)n, (unsigned long)trace_record_lost());
+        sc_emit_str(buf);
+        return;
+    }
+    else if (strcmp(cmd, ":replay") == 0 || strcmp(cmd, ":replay fast") == 0) {
+        if (trace_playing()) {
+            sc_emit_str("ERR busy\n");
+            return;
+        }
+        mode = SC_REPLAY;
+        trace_play_begin(cmd[7] != '\0');
+        sc_emit_str("READY\n");
+        return;
+    }
+    else if (strcmp(cmd, ":mem") == 0) {
+        sc_flush();
+        memstat_report();
+        return;
+    }
+    else if (strcmp(cmd, ":hist") == 0) {
+        sc_flush();
+        sc_history();
+        return;
+    }
+    else if (strcmp(cmd, ":gov") == 0) {
+        sc_flush();
+        gov_report();
+        return;
+    }
+    else if (strcmp(cmd, ":stats") == 0) {
+        uint32_t us = batch_last_us - batch_start_us;
+        uint32_t rate = us ? (uint32_t)((uint64_t)batch_count * 1000000u / us) : 0;
+        snprintf(buf, sizeof(buf), "STATS %lu %lu %lu\n",
+                 (unsigned long)batch_count, (unsigned long)us, (unsigned long)rate);
+        sc_emit_str(buf);
+        return;
+    }
+    else {
+        sc_emit_str("ERR cmd\n");
+        return;
+    }
+
+    // Entering batch mode starts a fresh measurement
+    batch_count = 0;
+    batch_start_us = batch_last_us = time_us_32();
+    sc_emit_str("READY\n");
+}
+
+// Handle the complete line in line[]. Returns false if it has to wait
+// for a worker slot.
+static bool sc_line(void) {
+    if (line_len == 0 && !line_too_long) {
+        return true;
+    }
+
+    if (line[0] == ':') {
+        if (in_flight > 0) {
+            return false; // answer after the results already queued
+        }
+        sc_command(line);
+        return true;
+    }
+
+    if (mode == SC_IDLE) {
+        return true; // plain text outside batch mode is ignored
+    }
+
+    if (mode == SC_REPLAY) {
+        return trace_play_feed(line); // waits while the trace queue is full
+    }
+    history_note_input(); // no page write in the middle of a batch
+
+    // Longer than a job holds: refuse it rather than evaluate a prefix,
+    // after the results still in flight so replies stay in order
+    if (line_too_long || line_len > WORKER_EXPR_MAX) {
+        if (in_flight > 0) {
+            return false;
+        }
+        batch_count++;
+        batch_last_us = time_us_32();
+        sc_emit_result(ERR_TOKEN_OVERFLOW, (truth_table_t){ 0 });
+        return true;
+    }
+
+    if (in_flight >= SC_MAX_IN_FLIGHT || !sc_out_has_room()) {
+        return false;
+    }
+    worker_job_t *job = worker_acquire();
+    if (job == NULL) {
+        return false;
+    }
+
+    job->kind = WORKER_JOB_BATCH;
+    job->row = 0;
+    strncpy(job->expr, line, WORKER_EXPR_MAX);
+    job->expr[WORKER_EXPR_MAX] = '\0';
+    in_flight++;
+    gov_boost();
+    worker_submit(job);
+    return true;
+}
+
+// ---------------------------------------------------------
+// 4. INPUT
+// ---------------------------------------------------------
+static void sc_fill(void) {
+    while (rx_head - rx_tail < SC_RX_LEN) {
+        int c = getchar_timeout_us(0);
+        if (c == PICO_ERROR_TIMEOUT) {
+            break;
+        }
+        rx[rx_head % SC_RX_LEN] = (char)c;
+        rx_head++;
+    }
+}
+
+static void sc_process(void) {
+    while (true) {
+        if (line_ready) {
+            if (!sc_line()) {
+                return; // wait for a slot
+            }
+            line_ready = false;
+            line_len = 0;
+            line_too_long = false;
+        }
+
+        if (rx_tail == rx_head) {
+            break;
+        }
+
+        char c = rx[rx_tail % SC_RX_LEN];
+        rx_tail++;
+
+        if (c == '\r' || c == '\n') {
+            line[line_len] = '\0';
+            line_ready = true;
+        }
+        else if (line_len < SC_LINE_MAX) {
+            line[line_len++] = c;
+        }
+        else {
+            line_too_long = true;
+        }
+    }
+
+    // Push out a full buffer, or whatever we have once idle
+    if (in_flight == 0 || !sc_out_has_room()) {
+        sc_flush();
+    }
+}
+
+void serialcmd_init(void) {
+    rx_head = rx_tail = 0;
+    line_len = 0;
+    line_ready = false;
+    out_len = 0;
+    mode = SC_IDLE;
+    in_flight = 0;
+}
+
+void serialcmd_on_input(void) {
+    sc_fill();
+    sc_process();
+}
+
+void serialcmd_service(void) {
+    sc_process();
+    sc_fill(); // the ring may have had no room when input arrived
+    sc_process();
+}
+
+void serialcmd_on_result(const worker_job_t *job) {
+    in_flight--;
+    batch_count++;
+    batch_last_us = time_us_32();
+    sc_emit_result(job->err, job->err == ERR_OK ? job->table : (truth_table_t){ 0 });
+}
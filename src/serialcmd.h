@@ -0,0 +1,40 @@
+#ifndef SERIALCMD_H
+#define SERIALCMD_H
+
+#include "worker.h"
+
+// Line-oriented command mode on stdio, for using the device as a bulk
+// evaluator from a host:
+//
+//   :batch hex   every following line is an expression; each answers
+//                "OK xx" (bit n of xx = row n) or "ERR n"; a line
+//                longer than WORKER_EXPR_MAX answers "ERR 3"
+//   :batch bin   same, but each answers two raw bytes: error code and
+//                packed table
+//   :end         leave batch mode (answers "END <count>")
+//   :stats       "STATS <count> <us> <expr/s>" for the last batch
+//   :prof        dump the profiling probes; ":prof reset" clears them
+//   :mem         stack high-water marks and static RAM totals
+//   :hist        flash history, newest first: "<n> <xx> <expr>" per entry
+//                after a "HIST" summary line, then "END <listed>"
+//   :gov         clock governor: time, estimated power and ENTER
+//                latency per clock mode ("GOV ..." lines)
+//   :rec         log keypad and knob input as trace records (trace.h);
+//                ":rec off" stops and answers "END <records> <dropped>",
+//                dropped being log lines lost to a full log ring while
+//                recording (any at all and the trace has gaps)
+//   :replay      every following line is a trace record, played at the
+//                recorded pace (":replay fast": as fast as the UI
+//                settles); ":end" closes the input, the report follows
+//
+// Results come back in submission order. Input is read without
+// blocking into a ring; when all worker slots are busy or output is
+// backed up, reading pauses and USB flow control holds the host off.
+// Output goes through the log ring, so it never blocks either.
+
+void serialcmd_init(void);
+void serialcmd_on_input(void);                     // EV_SERIAL
+void serialcmd_on_result(const worker_job_t *job); // finished WORKER_JOB_BATCH
+void serialcmd_service(void);                      // resume after slots free up
+
+#endif
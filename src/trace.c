@@ -0,0 +1,228 @@
+#include "trace.h"
+#include "keypad_mapped.h"
+#include "chardisp.h"
+#include "worker.h"
+#include "ui.h"
+#include "log.h"
+#include "prof.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include <stdlib.h>
+#include <string.h>
+
+// ---------------------------------------------------------
+// 1. RECORDING
+// ---------------------------------------------------------
+static bool recording = false;
+static uint32_t rec_start_us = 0;
+static uint32_t rec_count = 0;
+static int32_t rec_last_knob = -1;
+static uint32_t rec_dropped_at = 0; // log_dropped() when recording started
+static uint32_t rec_lost = 0;
+
+void trace_record_start(void) {
+    recording = true;
+    rec_start_us = time_us_32();
+    rec_count = 0;
+    rec_last_knob = -1;
+    rec_dropped_at = log_dropped();
+    rec_lost = 0;
+}
+
+uint32_t trace_record_stop(void) {
+    if (recording) {
+        rec_lost = log_dropped() - rec_dropped_at;
+    }
+    recording = false;
+    return rec_count;
+}
+
+uint32_t trace_record_lost(void) {
+    return rec_lost;
+}
+
+bool trace_recording(void) {
+    return recording;
+}
+
+void trace_record_key(uint16_t event) {
+    if (!recording) {
+        return;
+    }
+    log_printf("@K %lu %04x\n", (unsigned long)(time_us_32() - rec_start_us), event);
+    rec_count++;
+}
+
+// Only movements beyond the ADC noise are worth a record
+void trace_record_knob(uint16_t raw) {
+    if (!recording || (rec_last_knob >= 0 && abs((int32_t)raw - rec_last_knob) < TRACE_KNOB_DELTA)) {
+        return;
+    }
+    rec_last_knob = raw;
+    log_printf("@N %lu %u\n", (unsigned long)(time_us_32() - rec_start_us), raw);
+    rec_count++;
+}
+
+// ---------------------------------------------------------
+// 2. REPLAY
+// ---------------------------------------------------------
+typedef struct {
+    uint32_t t_us;
+    uint16_t value;
+    char kind; // 'K' or 'N'
+} trace_ev_t;
+
+static trace_ev_t q[TRACE_Q_LEN];
+static uint32_t q_head = 0;
+static uint32_t q_tail = 0;
+
+static bool playing = false;
+static bool fast = false;
+static bool input_done = false;
+static bool started = false;
+static uint32_t t_first = 0;       // recorded time of the first event
+static uint32_t play_start_us = 0; // when the first event was injected
+
+static bool waiting = false;       // an injected key has not settled yet
+static uint32_t inject_us = 0;
+static uint32_t settle_until_us = 0;
+
+static uint32_t n_events = 0;
+static uint32_t n_latency = 0;
+static uint32_t lat_min = 0;
+static uint32_t lat_max = 0;
+static uint64_t lat_sum = 0;
+static cd_stats_t cd_before;
+
+void trace_play_begin(bool fast_mode) {
+    q_head = q_tail = 0;
+    playing = true;
+    fast = fast_mode;
+    input_done = false;
+    started = false;
+    waiting = false;
+    settle_until_us = 0;
+    n_events = n_latency = 0;
+    lat_min = UINT32_MAX;
+    lat_max = 0;
+    lat_sum = 0;
+    cd_get_stats(&cd_before);
+    prof_reset(); // per-stage numbers cover the replay only
+}
+
+bool trace_play_feed(const char *line) {
+    const char *p = strchr(line, '@');
+    if (p == NULL || (p[1] != 'K' && p[1] != 'N')) {
+        return true; // not a record: skip
+    }
+    if (q_head - q_tail >= TRACE_Q_LEN) {
+        return false;
+    }
+
+    char *end;
+    trace_ev_t *e = &q[q_head % TRACE_Q_LEN];
+    e->kind = p[1];
+    e->t_us = (uint32_t)strtoul(p + 2, &end, 10);
+    e->value = (uint16_t)strtoul(end, NULL, e->kind == 'K' ? 16 : 10);
+    q_head++;
+    return true;
+}
+
+void trace_play_end(void) {
+    input_done = true;
+}
+
+bool trace_playing(void) {
+    return playing;
+}
+
+// Nothing left to do for the last injected key: its drawing has
+// reached the glass and any evaluation it started has come back
+static bool ui_settled(void) {
+    return !cd_busy() && !cd_frame_pending() && !worker_busy();
+}
+
+static void inject(const trace_ev_t *e, uint32_t now) {
+    if (e->kind == 'K') {
+        // The keypad alarm pushes into the same queue from its ISR
+        uint32_t irq = save_and_disable_interrupts();
+        key_push(e->value);
+        restore_interrupts(irq);
+        // Releases do no UI work; only presses open a latency window
+        waiting = (e->value & KEY_EV_PRESS) != 0;
+        inject_us = now;
+    }
+    else {
+        ui_knob_override(e->value);
+        settle_until_us = now + TRACE_KNOB_SETTLE_US;
+    }
+    n_events++;
+}
+
+static void report(void) {
+    cd_stats_t cd;
+    cd_get_stats(&cd);
+    uint32_t total = time_us_32() - play_start_us;
+
+    log_printf("REPLAY %s events=%lu time_us=%lu\n", fast ? "fast" : "paced",
+               (unsigned long)n_events, (unsigned long)(started ? total : 0));
+    if (n_latency) {
+        log_printf("LATENCY key_to_idle_us min=%lu avg=%lu max=%lu n=%lu\n", (unsigned long)lat_min,
+                   (unsigned long)(lat_sum / n_latency), (unsigned long)lat_max,
+                   (unsigned long)n_latency);
+    }
+    log_printf("DISPLAY frames=%lu updates=%lu requests=%lu coalesced=%lu\n",
+               (unsigned long)(cd.frames_total - cd_before.frames_total),
+               (unsigned long)(cd.updates - cd_before.updates),
+               (unsigned long)(cd.requests - cd_before.requests),
+               (unsigned long)(cd.coalesced - cd_before.coalesced));
+    prof_dump();
+}
+
+void trace_service(void) {
+    if (!playing) {
+        return;
+    }
+    uint32_t now = time_us_32();
+
+    if (waiting && ui_settled()) {
+        uint32_t lat = now - inject_us;
+        lat_min = lat < lat_min ? lat : lat_min;
+        lat_max = lat > lat_max ? lat : lat_max;
+        lat_sum += lat;
+        n_latency++;
+        waiting = false;
+    }
+
+    while (q_tail != q_head) {
+        const trace_ev_t *e = &q[q_tail % TRACE_Q_LEN];
+        if (!started) {
+            started = true;
+            t_first = e->t_us;
+            play_start_us = now;
+        }
+
+        if (fast) {
+            if (waiting || (int32_t)(now - settle_until_us) < 0) {
+                break;
+            }
+        }
+        else if (now - play_start_us < e->t_us - t_first) {
+            break;
+        }
+
+        // A key still settling when the next one is due overlaps it;
+        // its latency is not counted
+        inject(e, now);
+        q_tail++;
+        if (fast) {
+            break; // one at a time, each from an idle UI
+        }
+    }
+
+    if (input_done && q_tail == q_head && !waiting && (int32_t)(now - settle_until_us) >= 0) {
+        playing = false;
+        ui_knob_override(-1);
+        report();
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Input trace record/replay for repeatable end-to-end runs.
+//
+// Recording logs every keypad event and knob movement as it is
+// handled, one record per line, marked with '@' so the records can be
+// picked out of the console stream:
+//   @K <t_us> <event hex>   keypad queue event (see keypad_mapped.h)
+//   @N <t_us> <adc>         knob reading (median of the ADC ring)
+// The records share the log ring with everything else, and a full ring
+// drops lines; a recording that lost any is not a faithful trace.
+//
+// Replay pushes the events back into the keypad queue and the knob
+// reader, either at the recorded pace or as fast as the UI goes idle,
+// then reports events, total time, key-to-idle latency and display
+// traffic, followed by a :prof dump of the per-stage probes.
+
+#define TRACE_Q_LEN 64
+#define TRACE_KNOB_DELTA 16          // ADC counts between recorded knob records
+#define TRACE_KNOB_SETTLE_US 100000u // fast replay: knob filter settle time
+
+// --- Recording ---
+void trace_record_start(void);
+uint32_t trace_record_stop(void); // returns records written
+uint32_t trace_record_lost(void); // log lines dropped during the last recording
+bool trace_recording(void);
+void trace_record_key(uint16_t event);
+void trace_record_knob(uint16_t raw);
+
+// --- Replay ---
+void trace_play_begin(bool fast);
+bool trace_play_feed(const char *line); // false if the queue is full, retry later
+void trace_play_end(void);              // no more input: report once drained
+bool trace_playing(void);
+void trace_service(void);               // main loop: inject due events
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef TRUTHTABLE_H
+#define TRUTHTABLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Packed truth table: bit n is F for row n, where row n has the
+// variables as its binary digits (A the most significant). The storage
+// word is the smallest that holds every row, so with A, B, C a table
+// is one byte. Queries are single bit operations.
+
+#define TT_VARS 3
+#define TT_ROWS (1u << TT_VARS)
+#define TT_HEX_LEN ((TT_ROWS + 3) / 4) // digits from tt_to_hex
+
+#if TT_ROWS <= 8
+typedef uint8_t tt_bits_t;
+#elif TT_ROWS <= 16
+typedef uint16_t tt_bits_t;
+#elif TT_ROWS <= 32
+typedef uint32_t tt_bits_t;
+#else
+typedef uint64_t tt_bits_t;
+#endif
+
+typedef struct {
+    tt_bits_t bits;
+} truth_table_t;
+
+static inline bool tt_get(truth_table_t t, unsigned row) {
+    return (t.bits >> row) & 1u;
+}
+
+static inline void tt_set(truth_table_t *t, unsigned row, bool f) {
+    t->bits = (tt_bits_t)((t->bits & ~((tt_bits_t)1 << row)) | ((tt_bits_t)f << row));
+}
+
+// Number of rows where F = 1 (minterms)
+static inline int tt_count(truth_table_t t) {
+    return __builtin_popcountll(t.bits);
+}
+
+// First row where F = 1, or -1
+static inline int tt_first(truth_table_t t) {
+    return t.bits ? __builtin_ctzll(t.bits) : -1;
+}
+
+// Next row after 'row' where F = 1, or -1
+static inline int tt_next(truth_table_t t, int row) {
+    if (row + 1 >= (int)TT_ROWS) {
+        return -1;
+    }
+    uint64_t rest = (uint64_t)t.bits >> (row + 1);
+    return rest ? row + 1 + __builtin_ctzll(rest) : -1;
+}
+
+// Canonical hex, highest row first ("OK xx" in the serial protocol);
+// writes TT_HEX_LEN digits and a NUL
+static inline void tt_to_hex(truth_table_t t, char out[TT_HEX_LEN + 1]) {
+    static const char hex[] = "0123456789abcdef";
+    for (unsigned i = 0; i < TT_HEX_LEN; i++) {
+        out[i] = hex[((uint64_t)t.bits >> (4 * (TT_HEX_LEN - 1 - i))) & 0xF];
+    }
+    out[TT_HEX_LEN] = '\0';
+}
+
+#endif
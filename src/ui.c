@@ -0,0 +1,732 @@
+#include "ui.h"
+#include "pico/stdlib.h"
+#include "keypad_mapped.h"
+#include "chardisp.h"
+#include "outputbuilder.h"
+#include "gapbuf.h"
+#include "worker.h"
+#include "serialcmd.h"
+#include "log.h"
+#include "prof.h"
+#include "trace.h"
+#include "history.h"
+#include "clockgov.h"
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+#include <string.h>
+
+// Set in main.c
+extern const int KNOB_DMA_CHANNEL;
+
+#define LCD_COLS 16
+#define LCD_VIEW (2 * LCD_COLS) // expression chars visible at once
+#define EXPR_MAX GB_CAPACITY // 63
+#define ADC_PIN 45    // pot connected to GPIO 45 (from Lab 4)
+#define ADC_CHANNEL 5 // ADC channel 5 on RP2350
+
+static bool have_table = false;
+static int current_row = 0;
+
+// Result screen, rendered once per ENTER by the worker so a knob step
+// is just a line copy into the back buffer (not NUL-terminated)
+static char row_cache_expr[LCD_COLS];
+static char row_cache[TT_ROWS][LCD_COLS];
+
+static gapbuf_t expr;                // expression being edited
+static char expr_buf[EXPR_MAX + 1]; // flat copy handed to the evaluator
+
+// Rows of the compositor back buffer (set up after cd_init)
+static char *lcd_line1;
+static char *lcd_line2;
+static int lcd_row = 0; // 0 = first line, 1 = second line
+static int lcd_col = 0; // 0..15
+static int view_start = 0; // expression index shown at line 1, column 0
+
+static bool syntax_error_shown = false;
+static int hist_pos = -1; // history entry on screen, -1 = none
+static bool first_key_seen = false; // boot timing is logged once
+
+static void expr_clear(void)
+{
+    gb_init(&expr);
+    expr_buf[0] = '\0';
+}
+
+// Reprint the serial line after an edit away from the end of it
+static void serial_redraw_line(void)
+{
+    int len = gb_copy(&expr, expr_buf, sizeof(expr_buf));
+    LOG_INFO("\r> %s\x1b[K", expr_buf);
+    if (len > gb_cursor(&expr))
+    {
+        LOG_INFO("\x1b[%dD", len - gb_cursor(&expr)); // cursor back to edit point
+    }
+}
+
+static void lcd_clear_buffers(void);
+static void lcd_sync(void);
+static void lcd_put_char(char c);
+static void lcd_show_expr(void);
+
+// ---------------- LCD helper functions ----------------
+static void reset_input_and_lcd(void)
+{
+    expr_clear();            // clears the gap buffer and its undo history
+    have_table = false;
+    current_row = 0;
+
+    lcd_clear_buffers();
+    lcd_show_expr();
+}
+
+// Show error message and mark that we’re in “error mode”
+static void show_syntax_error(int err)
+{
+    have_table = false;
+    expr_clear();  // wipe any garbage expression
+
+    lcd_clear_buffers();
+    lcd_row = 0;
+    lcd_col = 0;
+
+    const char *msg = "SYNTAX ERROR";
+    for (int i = 0; msg[i] && i < LCD_COLS; ++i)
+    {
+        lcd_put_char(msg[i]);
+    }
+    lcd_sync();
+
+    LOG_ERROR("Error parsing expression (code %d)\n", err);
+
+    // Remember that the last thing we showed was an error
+    syntax_error_shown = true;
+}
+
+static void lcd_clear_buffers(void)
+{
+    memset(lcd_line1, ' ', LCD_COLS);
+    memset(lcd_line2, ' ', LCD_COLS);
+    lcd_line1[LCD_COLS] = '\0';
+    lcd_line2[LCD_COLS] = '\0';
+    lcd_row = 0;
+    lcd_col = 0;
+
+    // Fixed screens are drawn unscrolled and without a cursor
+    view_start = 0;
+    cd_set_view_shift(0);
+    cd_set_cursor(0, 0, false);
+}
+
+// Mark the back buffer changed; the compositor flushes it at frame rate
+static void lcd_sync(void)
+{
+    cd_invalidate();
+}
+
+// Put a single printable character of fixed text at current cursor
+// position, with automatic wrap from line 1 -> line 2.
+static void lcd_put_char(char c)
+{
+    if (c == '\n')
+    {
+        // ENTER just goes to the start of line 2
+        lcd_row = 1;
+        lcd_col = 0;
+        return;
+    }
+
+    // If first line is full, wrap to second line
+    if (lcd_row == 0 && lcd_col >= LCD_COLS)
+    {
+        lcd_row = 1;
+        lcd_col = 0;
+    }
+
+    // If second line is full, you can either:
+    //  - ignore extra characters, or
+    //  - overwrite the last one. For now, ignore.
+    if (lcd_row == 1 && lcd_col >= LCD_COLS)
+    {
+        return;
+    }
+
+    if (lcd_row == 0)
+    {
+        lcd_line1[lcd_col++] = c;
+    }
+    else
+    {
+        lcd_line2[lcd_col++] = c;
+    }
+
+    lcd_sync();
+}
+
+// Draw the expression as a 32-char window across both lines, scrolled
+// so the edit cursor stays visible. Expression char j
+// always lives in DDRAM column j % 40 on line 1 and (j - 16) % 40 on
+// line 2, so scrolling is a display shift: the controller keeps text
+// that scrolled out and only newly exposed cells need writing.
+static void lcd_show_expr(void)
+{
+    int len = gb_len(&expr);
+    int cursor = gb_cursor(&expr);
+    if (cursor < view_start)
+    {
+        view_start = cursor;
+    }
+    if (cursor > view_start + LCD_VIEW - 1)
+    {
+        view_start = cursor - (LCD_VIEW - 1);
+    }
+
+    for (int c = 0; c < LCD_COLS; ++c)
+    {
+        int i1 = view_start + c;
+        int i2 = view_start + LCD_COLS + c;
+        lcd_line1[c] = i1 < len ? gb_at(&expr, i1) : ' ';
+        lcd_line2[c] = i2 < len ? gb_at(&expr, i2) : ' ';
+    }
+
+    int rel = cursor - view_start;
+    cd_set_view_shift(view_start % CD_DDRAM_COLS);
+    cd_set_cursor(rel / LCD_COLS, rel % LCD_COLS, true);
+    lcd_sync();
+}
+
+// For ENTER (#) – clear and start over
+// static void lcd_handle_enter(void)
+// {
+//     lcd_clear_buffers();
+//     lcd_sync();
+// }
+
+// static void lcd_show_truth_table(const char *expr, const uint8_t outputs[8])
+// {
+//     // Clear screen
+//     lcd_clear_buffers();
+
+//     // Line 1: expression (truncated to 16 chars)
+//     lcd_row = 0;
+//     lcd_col = 0;
+//     for (int i = 0; i < LCD_COLS && expr[i] != '\0'; ++i)
+//     {
+//         lcd_put_char(expr[i]);
+//     }
+
+//     // Line 2: truth vector (8 bits as 0/1)
+//     lcd_row = 1;
+//     lcd_col = 0;
+//     for (int i = 0; i < 8 && lcd_col < LCD_COLS; ++i)
+//     {
+//         lcd_put_char(outputs[i] ? '1' : '0'); // or 'T'/'F' if you prefer
+//     }
+
+//     lcd_sync();
+// }
+
+// Show a cached result row: expression on line 1, (A,B,C,F) on line 2.
+// Line 1 is normally already on the glass; rewriting it costs nothing
+// after the compositor diff and repairs the screen if an edit key drew
+// over it in the meantime.
+static void lcd_show_cached_row(int row)
+{
+    memcpy(lcd_line1, row_cache_expr, LCD_COLS);
+    memcpy(lcd_line2, row_cache[row], LCD_COLS);
+
+    view_start = 0;
+    cd_set_view_shift(0);
+    cd_set_cursor(0, 0, false);
+    lcd_sync();
+}
+
+// ADC knob helpers
+//
+// The ADC free-runs in round-robin mode (just the knob channel) and DMA
+// streams every sample into a small ring, so reading the knob never
+// waits on a conversion. The row comes from the ring median, smoothed
+// by an IIR filter, with hysteresis around the row boundaries.
+
+#define KNOB_RING_BITS 4 // 16 samples
+#define KNOB_RING_LEN (1u << KNOB_RING_BITS)
+#define KNOB_SAMPLE_HZ 2000u
+#define KNOB_IIR_SHIFT 2 // new = old + (sample - old) / 4
+#define KNOB_HYST 64     // ADC counts past a boundary before the row changes
+#define KNOB_MOVED 32    // ADC counts of travel that count as input
+
+static uint16_t knob_ring[KNOB_RING_LEN] __attribute__((aligned(KNOB_RING_LEN * sizeof(uint16_t))));
+static int32_t knob_filtered = -1; // Q4 fixed point, -1 = not primed
+static int knob_row = 0;
+static int knob_noted = -1;        // filtered value at the last history_note_input
+static int knob_override = -1;     // replayed ADC value, -1 = live
+
+static void knob_adc_init(void)
+{
+    adc_init();
+    adc_gpio_init(ADC_PIN);        // route GPIO to ADC
+    adc_select_input(ADC_CHANNEL); // select channel
+    adc_set_round_robin(1u << ADC_CHANNEL);
+    adc_fifo_setup(true, true, 1, false, false); // DREQ on every sample
+    adc_set_clkdiv(48000000.0f / KNOB_SAMPLE_HZ - 1.0f);
+
+    for (unsigned i = 0; i < KNOB_RING_LEN; ++i)
+    {
+        knob_ring[i] = 0;
+    }
+
+    dma_channel_config c = dma_channel_get_default_config(KNOB_DMA_CHANNEL);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, KNOB_RING_BITS + 1); // wrap on ring bytes
+    channel_config_set_dreq(&c, DREQ_ADC);
+    dma_channel_configure(KNOB_DMA_CHANNEL, &c, knob_ring, &adc_hw->fifo,
+                          dma_encode_endless_transfer_count(), true);
+
+    adc_run(true);
+}
+
+// Median of the ring: rejects single-sample spikes
+static uint16_t knob_adc_read_raw(void)
+{
+    if (knob_override >= 0)
+    {
+        return (uint16_t)knob_override;
+    }
+
+    PROF_BEGIN(PROF_ADC_READ);
+    uint16_t v[KNOB_RING_LEN];
+    for (unsigned i = 0; i < KNOB_RING_LEN; ++i)
+    {
+        uint16_t x = knob_ring[i] & 0x0FFF;
+        unsigned j = i;
+        while (j > 0 && v[j - 1] > x)
+        {
+            v[j] = v[j - 1];
+            j--;
+        }
+        v[j] = x;
+    }
+    PROF_END(PROF_ADC_READ);
+    return v[KNOB_RING_LEN / 2]; // 0..4095
+}
+
+// Map 0..4095 -> 0..7
+static int knob_get_row_index(void)
+{
+    int32_t sample = (int32_t)knob_adc_read_raw() << 4;
+    if (knob_filtered < 0)
+    {
+        knob_filtered = sample;
+    }
+    knob_filtered += (sample - knob_filtered) >> KNOB_IIR_SHIFT;
+
+    int val = (int)(knob_filtered >> 4);
+
+    // A sweep holds page writes off like typing does; small moves are
+    // left to the ADC noise
+    if (knob_noted < 0 || val - knob_noted > KNOB_MOVED || knob_noted - val > KNOB_MOVED)
+    {
+        if (knob_noted >= 0)
+        {
+            history_note_input();
+        }
+        knob_noted = val;
+    }
+
+    int lo = knob_row * 512 - KNOB_HYST;
+    int hi = (knob_row + 1) * 512 + KNOB_HYST;
+
+    // Only move once the value is clearly inside another row
+    if (val < lo || val >= hi)
+    {
+        int row = (val * 8) / 4096; // 4095 maps to 7
+        if (row < 0)
+        {
+            row = 0;
+        }
+        if (row > 7)
+        {
+            row = 7;
+        }
+        knob_row = row;
+    }
+
+    return knob_row;
+}
+// ---------------- Serial result ----------------
+
+// The row bits and canonical hex, then the rows where F = 1
+static void log_truth_table(truth_table_t t)
+{
+    char bits[TT_ROWS + 1];
+    for (unsigned row = 0; row < TT_ROWS; ++row)
+    {
+        bits[row] = tt_get(t, row) ? '1' : '0';
+    }
+    bits[TT_ROWS] = '\0';
+
+    char hex[TT_HEX_LEN + 1];
+    tt_to_hex(t, hex);
+    LOG_INFO("Truth table (000..111): %s = %s\n", bits, hex);
+
+    char rows[3 * TT_ROWS + 1];
+    int n = 0;
+    for (int row = tt_first(t); row >= 0; row = tt_next(t, row))
+    {
+        rows[n++] = ' ';
+        if (row >= 10)
+        {
+            rows[n++] = (char)('0' + row / 10);
+        }
+        rows[n++] = (char)('0' + row % 10);
+    }
+    rows[n] = '\0';
+    LOG_INFO("Minterms: %d of %u:%s\n", tt_count(t), TT_ROWS, rows);
+}
+
+// ---------------- History recall ----------------
+
+// Step through the flash history (+1 = older). The stored table is
+// rendered straight into the row cache, so nothing is parsed again.
+// Only while the editor is empty, like the result screen itself.
+static void show_history_entry(int step)
+{
+    hist_entry_t h;
+    int pos = hist_pos + step;
+    if (gb_len(&expr) != 0 || !history_get(pos, &h))
+    {
+        return;
+    }
+    hist_pos = pos;
+
+    char text[EXPR_MAX + 1];
+    int len = h.len < EXPR_MAX ? h.len : EXPR_MAX;
+    memcpy(text, h.expr, (size_t)len);
+    text[len] = '\0';
+
+    char line1[LCD_COLS + 1];
+    worker_render_expr_line(line1, text);
+    memcpy(row_cache_expr, line1, LCD_COLS);
+    for (unsigned row = 0; row < TT_ROWS; ++row)
+    {
+        worker_render_row_line(row_cache[row], (int)row, tt_get(h.table, row));
+    }
+
+    have_table = true;
+    current_row = knob_get_row_index();
+    lcd_show_cached_row(current_row);
+    LOG_INFO("\nHistory %d: %s\n", pos + 1, text);
+    log_truth_table(h.table);
+    LOG_INFO("> ");
+}
+
+// ---------------- Event handlers ----------------
+
+// Handle one event from the keypad queue
+static void handle_key_event(uint16_t event)
+{
+    bool is_pressed = (event & KEY_EV_PRESS) != 0;
+    if (!is_pressed)
+    {
+        return;
+    }
+
+    const char *boolean_str = key_event_token(event);
+    if (boolean_str == NULL)
+    {
+        return;
+    }
+
+    // NEW: if we were showing a syntax error, clear LCD + expr
+    if (syntax_error_shown)
+    {
+        reset_input_and_lcd();
+        syntax_error_shown = false;
+    }
+
+    char ctl = boolean_str[0];
+
+    if (ctl == TOK_PROF_DUMP[0])
+    {
+        // *+# chord: profiling stats to serial
+        prof_dump();
+        gov_report();
+        return;
+    }
+
+    if (ctl == TOK_HIST_OLDER[0] || ctl == TOK_HIST_NEWER[0])
+    {
+        show_history_entry(ctl == TOK_HIST_OLDER[0] ? 1 : -1);
+        return;
+    }
+
+    bool at_end = gb_cursor(&expr) == gb_len(&expr);
+
+    // ---------- EDITING KEYS ----------
+    // Each key press is one undo group; the LCD and the
+    // serial line are redrawn from the gap buffer.
+    if (ctl == '\b' || ctl == TOK_DELETE[0] || ctl == TOK_CLEAR_TO_START[0]
+        || ctl == TOK_UNDO[0] || ctl == TOK_CURSOR_LEFT[0] || ctl == TOK_CURSOR_RIGHT[0]
+        || ctl == TOK_CURSOR_HOME[0] || ctl == TOK_CURSOR_END[0])
+    {
+        if (ctl != TOK_UNDO[0])
+        {
+            gb_begin_group(&expr);
+        }
+
+        if (ctl == '\b')
+        {
+            gb_backspace(&expr);
+        }
+        else if (ctl == TOK_DELETE[0])
+        {
+            gb_delete(&expr);
+        }
+        else if (ctl == TOK_CLEAR_TO_START[0])
+        {
+            gb_clear_to_start(&expr);
+        }
+        else if (ctl == TOK_UNDO[0])
+        {
+            gb_undo(&expr);
+        }
+        else if (ctl == TOK_CURSOR_LEFT[0])
+        {
+            gb_left(&expr);
+        }
+        else if (ctl == TOK_CURSOR_RIGHT[0])
+        {
+            gb_right(&expr);
+        }
+        else if (ctl == TOK_CURSOR_HOME[0])
+        {
+            gb_move_to(&expr, 0);
+        }
+        else
+        {
+            gb_move_to(&expr, gb_len(&expr));
+        }
+
+        if (ctl == '\b' && at_end)
+        {
+            LOG_INFO("\b \b");
+        }
+        else
+        {
+            serial_redraw_line();
+        }
+
+        lcd_show_expr();
+    }
+    else if (boolean_str[0] == '\n')
+    {
+        // ENTER key: hand the expression to the worker; on_result
+        // shows the truth table when it comes back
+        LOG_INFO("\n");
+
+        worker_job_t *job = worker_acquire();
+        if (job == NULL)
+        {
+            // Every slot is still being evaluated: keep the expression
+            LOG_WARN("Busy, press ENTER again\n");
+            serial_redraw_line();
+            return;
+        }
+
+        job->kind = WORKER_JOB_UI;
+        job->row = (uint8_t)knob_get_row_index(); // initial row from the knob
+        gb_copy(&expr, job->expr, sizeof(job->expr));
+        gov_enter(); // full clock for the parse, evaluation and render
+        worker_submit(job);
+
+        // Reset expression for next time
+        expr_clear();
+    }
+    else
+    {
+        // Normal token (A, B, C, &, |, !, ^, (, ))
+
+        // If we were in table view and expr is empty,
+        // this is the start of a new expression: exit table mode.
+        if (gb_len(&expr) == 0 && have_table)
+        {
+            have_table = false;
+            hist_pos = -1;
+            lcd_clear_buffers();
+            lcd_sync();
+        }
+
+        // 1) insert at the cursor (skip spaces just in case)
+        gb_begin_group(&expr);
+        for (int i = 0; boolean_str[i] != '\0'; ++i)
+        {
+            char c = boolean_str[i];
+            if (c == ' ')
+                continue;
+
+            gb_insert(&expr, c); // drops chars once full
+        }
+
+        // 2) serial echo: plain append at the end of line
+        if (at_end)
+        {
+            LOG_INFO("%s", boolean_str);
+        }
+        else
+        {
+            serial_redraw_line();
+        }
+
+        // 3) update LCD, scrolling to keep the cursor in view
+        lcd_show_expr();
+    }
+}
+
+// A keypad ENTER came back from the worker
+static void apply_ui_result(const worker_job_t *job)
+{
+    // If typing already started a new expression, don't clobber it
+    bool idle = gb_len(&expr) == 0;
+
+    if (job->err == ERR_OK)
+    {
+        // Keep every rendered row for knob-based viewing
+        memcpy(row_cache_expr, job->line1, LCD_COLS);
+        memcpy(row_cache, job->rows, sizeof(row_cache));
+
+        history_append(job->expr, job->table);
+        hist_pos = -1;
+
+        if (idle)
+        {
+            have_table = true;
+            current_row = job->row;
+            lcd_show_cached_row(current_row);
+            cd_commit(); // show the result without waiting a frame
+        }
+
+        // Also print full truth table on serial
+        log_truth_table(job->table);
+    }
+    else if (idle)
+    {
+        // Use the dedicated handler
+        show_syntax_error(job->err);
+    }
+    else
+    {
+        LOG_ERROR("Error parsing expression (code %d)\n", job->err);
+    }
+    gov_result_shown();
+
+    // Start new prompt on serial
+    LOG_INFO("> ");
+}
+
+static void on_result(void)
+{
+    worker_job_t *job;
+    while ((job = worker_poll()) != NULL)
+    {
+        if (job->kind == WORKER_JOB_UI)
+        {
+            apply_ui_result(job);
+        }
+        else if (job->kind == WORKER_JOB_BATCH)
+        {
+            serialcmd_on_result(job);
+        }
+        worker_release(job);
+    }
+
+    // Slots freed up: let the batch reader continue
+    serialcmd_service();
+}
+
+static void on_key(void)
+{
+    uint16_t event;
+    while (key_pop(&event))
+    {
+        history_note_input();
+        if (!first_key_seen && (event & KEY_EV_PRESS))
+        {
+            // The timer starts at zero on reset, so this is time from boot
+            first_key_seen = true;
+            LOG_INFO("BOOT first_key_us=%lu\n", (unsigned long)time_us_32());
+        }
+        trace_record_key(event);
+        PROF_BEGIN(PROF_KEY);
+        handle_key_event(event);
+        PROF_END(PROF_KEY);
+    }
+
+    // Flush any UI drawing, at most once per frame interval
+    cd_service();
+}
+
+// Periodic tick: knob and deferred display frames
+static void on_tick(void)
+{
+    if (trace_recording())
+    {
+        trace_record_knob(knob_adc_read_raw());
+    }
+
+    // --- Knob update: if we have a valid table, use ADC to pick row ---
+    if (have_table)
+    {
+        int row = knob_get_row_index();
+        if (row != current_row)
+        {
+            PROF_BEGIN(PROF_KNOB_STEP);
+            current_row = row;
+            lcd_show_cached_row(current_row);
+            PROF_END(PROF_KNOB_STEP);
+        }
+    }
+
+    history_service(); // page write once the input has gone quiet
+    cd_service();
+    gov_service();     // back to the idle clock once the work is done
+}
+
+// Serial input: batch command protocol
+static void on_serial(void)
+{
+    serialcmd_on_input();
+}
+
+// The display went idle; a frame may have been held back meanwhile
+static void on_display_idle(void)
+{
+    cd_service();
+    gov_service(); // a clock switch may have been waiting for the display
+}
+
+const ev_handler_t ui_handlers[EV_COUNT] = {
+    [EV_KEY] = on_key,
+    [EV_TICK] = on_tick,
+    [EV_SERIAL] = on_serial,
+    [EV_DISPLAY] = on_display_idle,
+    [EV_RESULT] = on_result,
+};
+
+void ui_knob_override(int raw)
+{
+    knob_override = raw;
+}
+
+void ui_init(void)
+{
+    lcd_line1 = cd_back_row(0);
+    lcd_line2 = cd_back_row(1);
+    expr_clear();
+    have_table = false;
+    current_row = 0;
+    lcd_clear_buffers();
+    lcd_show_expr();
+
+    knob_adc_init();
+}
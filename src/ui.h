@@ -0,0 +1,20 @@
+#ifndef UI_H
+#define UI_H
+
+#include "events.h"
+
+// Calculator UI: the expression editor, result screen and knob
+// browsing. It draws into the chardisp compositor and reacts to the
+// events in ui_handlers; main.c owns the hardware bring-up and the
+// event loop, so the same code runs under the host harnesses.
+
+// After cd_init: draws the empty prompt and starts the knob ADC
+void ui_init(void);
+
+extern const ev_handler_t ui_handlers[EV_COUNT];
+
+// Trace replay: read the knob as this ADC value (0..4095) instead of
+// the ring; -1 goes back to the live ADC
+void ui_knob_override(int raw);
+
+#endif
@@ -0,0 +1,158 @@
+#include "worker.h"
+#include "outputbuilder.h"
+#include "events.h"
+#include "prof.h"
+#include "memstat.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#if WORKER_DUAL_CORE
+#include "pico/multicore.h"
+#include "pico/flash.h"
+#endif
+
+// ---------------------------------------------------------
+// 1. JOB SLOTS
+// ---------------------------------------------------------
+static worker_job_t jobs[WORKER_SLOTS];
+static bool slot_busy[WORKER_SLOTS]; // core0 only
+
+// Finished slot indices, filled by the FIFO IRQ (or inline) on core0
+static volatile uint8_t done_q[WORKER_SLOTS];
+static volatile int done_head = 0;
+static volatile int done_tail = 0;
+
+static void done_push(uint32_t slot) {
+    done_q[done_head % WORKER_SLOTS] = (uint8_t)slot;
+    done_head = done_head + 1;
+}
+
+// ---------------------------------------------------------
+// 2. RENDERING
+// ---------------------------------------------------------
+void worker_render_expr_line(char out[WORKER_COLS + 1], const char *expr) {
+    int i = 0;
+    for (; i < WORKER_COLS && expr[i] != '\0'; i++) {
+        out[i] = expr[i];
+    }
+    for (; i < WORKER_COLS; i++) {
+        out[i] = ' ';
+    }
+    out[WORKER_COLS] = '\0';
+}
+
+// "r3:011 F=1", padded with blanks and not terminated. Hand-rolled so
+// core1 never touches the shared newlib state behind snprintf.
+void worker_render_row_line(char out[WORKER_COLS], int row, int f) {
+    int n = 0;
+    out[n++] = 'r';
+    out[n++] = (char)('0' + row);
+    out[n++] = ':';
+    out[n++] = (char)('0' + ((row >> 2) & 1));
+    out[n++] = (char)('0' + ((row >> 1) & 1));
+    out[n++] = (char)('0' + (row & 1));
+    out[n++] = ' ';
+    out[n++] = 'F';
+    out[n++] = '=';
+    out[n++] = f ? '1' : '0';
+    while (n < WORKER_COLS) {
+        out[n++] = ' ';
+    }
+}
+
+// ---------------------------------------------------------
+// 3. EVALUATION
+// ---------------------------------------------------------
+static void worker_process(worker_job_t *job) {
+    job->err = build_truth_table(job->expr, &job->table);
+    if (job->err != ERR_OK || job->kind != WORKER_JOB_UI) {
+        return; // batch results go out as the packed table
+    }
+    worker_render_expr_line(job->line1, job->expr);
+    for (unsigned row = 0; row < TT_ROWS; row++) {
+        worker_render_row_line(job->rows[row], (int)row, tt_get(job->table, row));
+    }
+}
+
+#if WORKER_DUAL_CORE
+static void worker_core1_main(void) {
+    prof_init(); // the cycle counter is per core
+    // History page writes lock this core out; on RP2350 the lockout
+    // signals through a doorbell, so the FIFO still carries only slots
+    flash_safe_execute_core_init();
+
+    while (true) {
+        uint32_t slot = multicore_fifo_pop_blocking();
+        worker_process(&jobs[slot]);
+        __dmb(); // results visible before core0 sees the index
+        multicore_fifo_push_blocking(slot);
+    }
+}
+
+static void worker_fifo_isr(void) {
+    while (multicore_fifo_rvalid()) {
+        done_push(multicore_fifo_pop_blocking());
+    }
+    multicore_fifo_clear_irq();
+    ev_post(EV_RESULT);
+}
+#endif
+
+// ---------------------------------------------------------
+// 4. PUBLIC API
+// ---------------------------------------------------------
+void worker_init(void) {
+    for (int i = 0; i < WORKER_SLOTS; i++) {
+        slot_busy[i] = false;
+    }
+#if WORKER_DUAL_CORE
+    memstat_paint_core1();
+    multicore_launch_core1(worker_core1_main);
+    multicore_fifo_clear_irq();
+    irq_set_exclusive_handler(SIO_IRQ_FIFO, worker_fifo_isr);
+    irq_set_enabled(SIO_IRQ_FIFO, true);
+#endif
+}
+
+worker_job_t *worker_acquire(void) {
+    for (int i = 0; i < WORKER_SLOTS; i++) {
+        if (!slot_busy[i]) {
+            slot_busy[i] = true;
+            return &jobs[i];
+        }
+    }
+    return NULL;
+}
+
+void worker_submit(worker_job_t *job) {
+    uint32_t slot = (uint32_t)(job - jobs);
+#if WORKER_DUAL_CORE
+    __dmb(); // job contents visible before core1 sees the index
+    multicore_fifo_push_blocking(slot);
+#else
+    worker_process(job);
+    done_push(slot);
+    ev_post(EV_RESULT);
+#endif
+}
+
+worker_job_t *worker_poll(void) {
+    if (done_tail == done_head) {
+        return NULL;
+    }
+    uint8_t slot = done_q[done_tail % WORKER_SLOTS];
+    done_tail = done_tail + 1;
+    return &jobs[slot];
+}
+
+void worker_release(worker_job_t *job) {
+    slot_busy[job - jobs] = false;
+}
+
+bool worker_busy(void) {
+    for (int i = 0; i < WORKER_SLOTS; i++) {
+        if (slot_busy[i]) {
+            return true;
+        }
+    }
+    return false;
+}
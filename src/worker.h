@@ -0,0 +1,58 @@
+#ifndef WORKER_H
+#define WORKER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "truthtable.h"
+
+// Evaluation worker. With WORKER_DUAL_CORE set, core1 parses and
+// evaluates expressions and renders the result screen while core0 keeps
+// servicing the keypad, knob and serial. Jobs travel between the cores
+// as slot indices through the SIO inter-core FIFO; a finished job posts
+// EV_RESULT on core0. With it clear, jobs run inline on submit.
+//
+// A successful job carries the whole result screen: the truncated
+// expression and one line-2 rendering per truth table row, so the UI
+// never formats anything while the knob is browsing.
+
+#ifndef WORKER_DUAL_CORE
+#define WORKER_DUAL_CORE 1
+#endif
+
+#define WORKER_EXPR_MAX 63
+#define WORKER_SLOTS 4
+#define WORKER_COLS 16
+
+typedef enum {
+    WORKER_JOB_UI = 0, // ENTER from the keypad
+    WORKER_JOB_BATCH,  // expression from the serial batch protocol
+} worker_kind_t;
+
+typedef struct {
+    // --- Filled by the submitter ---
+    uint8_t kind;                  // worker_kind_t
+    uint8_t row;                   // row the knob was on at ENTER
+    char expr[WORKER_EXPR_MAX + 1];
+
+    // --- Filled by the worker ---
+    int err;                       // ERR_* from outputbuilder.h
+    truth_table_t table;
+    char line1[WORKER_COLS + 1];   // expression, truncated
+    char rows[TT_ROWS][WORKER_COLS]; // "rN:ABC F=x" per row, not terminated
+} worker_job_t;
+
+// --- Setup ---
+void worker_init(void); // launches core1 in dual-core mode
+
+// --- Job flow (core0 only) ---
+worker_job_t *worker_acquire(void);     // free slot or NULL if all busy
+void worker_submit(worker_job_t *job);
+worker_job_t *worker_poll(void);        // next finished job or NULL
+void worker_release(worker_job_t *job);
+bool worker_busy(void);                 // any slot acquired and not released
+
+// --- Rendering helpers (either core) ---
+void worker_render_expr_line(char out[WORKER_COLS + 1], const char *expr);
+void worker_render_row_line(char out[WORKER_COLS], int row, int f);
+
+#endif
@@ -0,0 +1,62 @@
+# PlatformIO post-build step: static memory budget per module.
+#
+# Prints .data/.bss per object file and the largest symbols in each,
+# so buffer sizes (MAX_NODES, Q_SIZE, GB_CAPACITY, ...) can be tuned
+# from data. Sizes can be overridden with build_flags, e.g.
+#   build_flags = -DMAX_NODES=48 -DQ_SIZE=16
+
+import os
+import subprocess
+
+Import("env")
+
+TOP_SYMBOLS = 4
+
+
+def _tool(name):
+    size_tool = env.subst("$SIZETOOL")
+    return size_tool[: -len("size")] + name if size_tool.endswith("size") else name
+
+
+def _sections(obj):
+    out = subprocess.run([_tool("size"), "-A", obj], capture_output=True, text=True).stdout
+    sizes = {".data": 0, ".bss": 0}
+    for line in out.splitlines():
+        parts = line.split()
+        if len(parts) >= 2 and parts[1].isdigit():
+            for sec in sizes:
+                if parts[0] == sec or parts[0].startswith(sec + "."):
+                    sizes[sec] += int(parts[1])
+    return sizes
+
+
+def _symbols(obj):
+    out = subprocess.run([_tool("nm"), "-S", "--size-sort", obj], capture_output=True, text=True).stdout
+    syms = []
+    for line in out.splitlines():
+        parts = line.split()
+        if len(parts) == 4 and parts[2] in "bBdD":
+            syms.append((int(parts[1], 16), parts[3]))
+    return sorted(syms, reverse=True)[:TOP_SYMBOLS]
+
+
+def memreport(source, target, env):
+    src_dir = os.path.join(env.subst("$BUILD_DIR"), "src")
+    if not os.path.isdir(src_dir):
+        return
+
+    print("Static RAM per module (.data + .bss):")
+    total = 0
+    for name in sorted(os.listdir(src_dir)):
+        if not name.endswith(".o"):
+            continue
+        obj = os.path.join(src_dir, name)
+        sizes = _sections(obj)
+        used = sizes[".data"] + sizes[".bss"]
+        total += used
+        syms = ", ".join("%s=%d" % (sym, size) for size, sym in _symbols(obj))
+        print("  %-18s data %5d  bss %6d  %s" % (name[:-2], sizes[".data"], sizes[".bss"], syms))
+    print("  %-18s %d bytes" % ("total (src/)", total))
+
+
+env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", memreport)